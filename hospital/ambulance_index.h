@@ -0,0 +1,194 @@
+// Spatial index of IDLE ambulances: uniform grid buckets over the service
+// area, updated incrementally when a unit changes status. Answers k-nearest
+// queries ranked by road travel distance, from A* or, when the city has
+// one, a precomputed DistanceTable.
+
+#pragma once
+
+#include "sim_types.h"
+#include "road_graph.h"
+#include "road_snapper.h"
+#include "distance_table.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+class IdleFleetIndex
+{
+public:
+    struct Candidate
+    {
+        int unit = -1;
+        float roadDist = 0.0f;
+    };
+
+    IdleFleetIndex() = default;
+
+    // Positions outside `area` are clamped into the border cells, which keeps
+    // the ring-search bound valid.
+    void reset(Rect area, float cellSize = 200.0f)
+    {
+        originX = area.x;
+        originY = area.y;
+        cell = max(cellSize, 1.0f);
+        gridW = max(1, (int)ceilf(area.width / cell));
+        gridH = max(1, (int)ceilf(area.height / cell));
+        buckets.assign((size_t)gridW * gridH, {});
+        for (auto &s : slots)
+            s = Slot{};
+        count = 0;
+    }
+
+    void insert(int unit, Vec2 p)
+    {
+        if (unit >= (int)slots.size())
+        {
+            slots.resize(unit + 1);
+            unitPos.resize(unit + 1);
+        }
+        if (slots[unit].cell >= 0)
+            erase(unit);
+        int c = cellOf(p);
+        slots[unit] = Slot{c, (int)buckets[c].size()};
+        unitPos[unit] = p;
+        buckets[c].push_back(unit);
+        count++;
+    }
+
+    void erase(int unit)
+    {
+        if (unit >= (int)slots.size() || slots[unit].cell < 0)
+            return;
+        Slot s = slots[unit];
+        vector<int> &b = buckets[s.cell];
+        int moved = b.back();
+        b[s.index] = moved;
+        slots[moved].index = s.index;
+        b.pop_back();
+        slots[unit] = Slot{};
+        count--;
+    }
+
+    bool contains(int unit) const { return unit < (int)slots.size() && slots[unit].cell >= 0; }
+
+    // Every indexed unit, in bucket order.
+    void collect(vector<int> &out) const
+    {
+        out.clear();
+        for (auto &b : buckets)
+            out.insert(out.end(), b.begin(), b.end());
+    }
+    int size() const { return count; }
+
+    // Up to k indexed units closest to target by road, nearest first. Road
+    // distance is never shorter than the straight line, so the search grows
+    // rings of cells until the k-th best road distance is within the ring
+    // radius, and skips the road query for units that cannot beat it.
+    // With a `table` each road query is a lookup instead of an A* search.
+    int kNearest(Vec2 target, int k, const RoadGraph &graph, const RoadSnapper &snapper, vector<Candidate> &out,
+                 const DistanceTable *table = nullptr) const
+    {
+        out.clear();
+        if (k <= 0 || count == 0)
+            return 0;
+        int goalNode = snapper.nearest(target);
+        Vec2 goal = goalNode >= 0 ? graph.position(goalNode) : target;
+        float tail = hypotf(target.x - goal.x, target.y - goal.y);
+        vector<int> &nodes = pathScratch();
+
+        auto worse = [](const Candidate &a, const Candidate &b) { return a.roadDist < b.roadDist; };
+        int cx = cellX(target.x), cy = cellY(target.y);
+        int seen = 0;
+        int maxRing = max(gridW, gridH);
+        for (int r = 0; r <= maxRing && seen < count; ++r)
+        {
+            for (int y = cy - r; y <= cy + r; ++y)
+            {
+                if (y < 0 || y >= gridH)
+                    continue;
+                int step = (y == cy - r || y == cy + r) ? 1 : max(2 * r, 1);
+                for (int x = cx - r; x <= cx + r; x += step)
+                {
+                    if (x < 0 || x >= gridW)
+                        continue;
+                    for (int unit : buckets[y * gridW + x])
+                    {
+                        seen++;
+                        Vec2 p = unitPos[unit];
+                        float straight = hypotf(p.x - target.x, p.y - target.y);
+                        if ((int)out.size() == k && straight >= out.front().roadDist)
+                            continue;
+                        float d = roadDistance(p, goalNode, tail, graph, snapper, table, nodes);
+                        if ((int)out.size() == k)
+                        {
+                            if (d >= out.front().roadDist)
+                                continue;
+                            pop_heap(out.begin(), out.end(), worse);
+                            out.pop_back();
+                        }
+                        out.push_back({unit, d});
+                        push_heap(out.begin(), out.end(), worse);
+                    }
+                }
+            }
+            // every unit outside rings 0..r is at least r cells away
+            if ((int)out.size() == k && out.front().roadDist <= r * cell)
+                break;
+        }
+        sort_heap(out.begin(), out.end(), worse);
+        return (int)out.size();
+    }
+
+    // Closest unit by road, -1 when the index is empty.
+    int nearest(Vec2 target, const RoadGraph &graph, const RoadSnapper &snapper, const DistanceTable *table = nullptr) const
+    {
+        vector<Candidate> &best = candidateScratch();
+        return kNearest(target, 1, graph, snapper, best, table) ? best[0].unit : -1;
+    }
+
+private:
+    struct Slot
+    {
+        int cell = -1, index = -1;
+    };
+
+    float originX = 0, originY = 0, cell = 200.0f;
+    int gridW = 1, gridH = 1;
+    vector<vector<int>> buckets = vector<vector<int>>(1);
+    vector<Slot> slots;
+    vector<Vec2> unitPos;
+    int count = 0;
+
+    static int clampi(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
+    int cellX(float x) const { return clampi((int)floorf((x - originX) / cell), 0, gridW - 1); }
+    int cellY(float y) const { return clampi((int)floorf((y - originY) / cell), 0, gridH - 1); }
+    int cellOf(Vec2 p) const { return cellY(p.y) * gridW + cellX(p.x); }
+
+    // Length of the route RoadGraph::route would produce: drive to the
+    // nearest intersection, follow the roads, then the last stretch to target.
+    static float roadDistance(Vec2 from, int goalNode, float tail, const RoadGraph &graph, const RoadSnapper &snapper,
+                              const DistanceTable *table, vector<int> &nodes)
+    {
+        int s = snapper.nearest(from);
+        if (s < 0 || goalNode < 0)
+            return numeric_limits<float>::infinity();
+        float g = table ? table->distance(s, goalNode) : graph.shortestPath(s, goalNode, nodes);
+        if (g < 0.0f)
+            return numeric_limits<float>::infinity();
+        Vec2 sp = graph.position(s);
+        return hypotf(from.x - sp.x, from.y - sp.y) + g + tail;
+    }
+
+    static vector<int> &pathScratch()
+    {
+        static thread_local vector<int> v;
+        return v;
+    }
+
+    static vector<Candidate> &candidateScratch()
+    {
+        static thread_local vector<Candidate> v;
+        return v;
+    }
+};
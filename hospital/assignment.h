@@ -0,0 +1,227 @@
+// Min-cost assignment of n rows to m >= n columns: Hungarian method in its
+// shortest-augmenting-path form (Jonker-Volgenant / Crouse), O(n^2 m) worst
+// case. Used by the batch dispatcher to match waiting calls to idle units
+// as a whole instead of one call at a time.
+
+#pragma once
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+class AssignmentSolver
+{
+public:
+    // cost is row-major n x m. Fills rowToCol (size n) and returns the total
+    // cost. Buffers are kept between calls.
+    double solve(const vector<float> &cost, int n, int m, vector<int> &rowToCol)
+    {
+        rowToCol.assign(n, -1);
+        if (n == 0 || m < n)
+            return 0.0;
+        colToRow.assign(m, -1);
+        u.assign(n, 0.0);
+        v.assign(m, 0.0);
+
+        // Initial matching. Square problems start from column minima as
+        // column duals (every column must be used, so this is safe); then
+        // each row whose cheapest reduced column is still free takes it.
+        // When every row gets its own minimum (calls far apart) that is
+        // already the answer.
+        if (n == m)
+        {
+            fill(v.begin(), v.end(), numeric_limits<double>::infinity());
+            for (int i = 0; i < n; ++i)
+            {
+                const float *row = cost.data() + (size_t)i * m;
+                for (int j = 0; j < m; ++j)
+                    v[j] = min(v[j], (double)row[j]);
+            }
+        }
+        freeRows.clear();
+        for (int i = 0; i < n; ++i)
+        {
+            const float *row = cost.data() + (size_t)i * m;
+            int best = 0;
+            for (int j = 1; j < m; ++j)
+                if (row[j] - v[j] < row[best] - v[best])
+                    best = j;
+            if (colToRow[best] < 0)
+            {
+                colToRow[best] = i;
+                rowToCol[i] = best;
+            }
+            else
+                freeRows.push_back(i);
+        }
+        if (!freeRows.empty())
+        {
+            augmentingRowReduction(cost, m, rowToCol);
+            augmentingRowReduction(cost, m, rowToCol);
+        }
+
+        // duals: matched rows are tight on their column, free rows sit at
+        // their reduced-cost minimum, so all reduced costs are >= 0
+        for (int i = 0; i < n; ++i)
+        {
+            const float *row = cost.data() + (size_t)i * m;
+            if (rowToCol[i] >= 0)
+                u[i] = row[rowToCol[i]] - v[rowToCol[i]];
+            else
+            {
+                double best = numeric_limits<double>::infinity();
+                for (int j = 0; j < m; ++j)
+                    best = min(best, row[j] - v[j]);
+                u[i] = best;
+            }
+        }
+
+        spc.assign(m, 0.0);
+        remCol.resize(m);
+        remKey.resize(m);
+        remV.resize(m);
+        path.assign(m, -1);
+        for (int r : freeRows)
+            augment(cost, m, r, rowToCol);
+
+        double t = 0.0;
+        for (int i = 0; i < n; ++i)
+            t += cost[(size_t)i * m + rowToCol[i]];
+        return t;
+    }
+
+private:
+    vector<double> u, v, spc; // row/column duals, shortest path cost per column
+    vector<int> colToRow, path, freeRows, pending, visitedRows, visitedCols;
+    vector<int> remCol; // augment: unscanned columns with their distance and dual
+    vector<double> remKey, remV;
+
+    // Jonker-Volgenant augmenting row reduction: each free row takes the
+    // column with the smallest reduced cost and lowers that column's dual to
+    // its second-smallest, evicting the previous owner, who then tries again.
+    // Cheap, and leaves only a few rows for the full shortest-path search.
+    void augmentingRowReduction(const vector<float> &cost, int m, vector<int> &rowToCol)
+    {
+        pending.swap(freeRows);
+        freeRows.clear();
+        size_t k = 0;
+        long long budget = (long long)pending.size() * 8; // bounds eviction chains
+        while (k < pending.size())
+        {
+            int i = pending[k++];
+            const float *row = cost.data() + (size_t)i * m;
+            double u1 = numeric_limits<double>::infinity(), u2 = u1;
+            int j1 = -1, j2 = -1;
+            for (int j = 0; j < m; ++j)
+            {
+                double h = row[j] - v[j];
+                if (h < u2)
+                {
+                    if (h < u1)
+                    {
+                        u2 = u1;
+                        j2 = j1;
+                        u1 = h;
+                        j1 = j;
+                    }
+                    else
+                    {
+                        u2 = h;
+                        j2 = j;
+                    }
+                }
+            }
+            int i0 = colToRow[j1];
+            if (u1 < u2)
+                v[j1] -= u2 - u1;
+            else if (i0 >= 0 && j2 >= 0)
+            {
+                // tie: take the second column instead of evicting
+                j1 = j2;
+                i0 = colToRow[j1];
+            }
+            if (i0 >= 0)
+            {
+                rowToCol[i0] = -1;
+                if (u1 < u2 && --budget > 0)
+                    pending[--k] = i0; // retry the evicted row right away
+                else
+                    freeRows.push_back(i0);
+            }
+            rowToCol[i] = j1;
+            colToRow[j1] = i;
+        }
+    }
+
+    // Dijkstra over reduced costs from free row `start` to the nearest free
+    // column, then flip the path and update the duals of what it touched.
+    // Unscanned columns are kept compacted (column, tentative distance,
+    // dual) so each step is one linear pass that shrinks by one.
+    void augment(const vector<float> &cost, int m, int start, vector<int> &rowToCol)
+    {
+        for (int j = 0; j < m; ++j)
+        {
+            remCol[j] = j;
+            remKey[j] = numeric_limits<double>::infinity();
+            remV[j] = v[j];
+        }
+        int numRemaining = m;
+        visitedRows.clear();
+        visitedCols.clear();
+
+        double minVal = 0.0;
+        int i = start, sink = -1;
+        while (sink < 0)
+        {
+            visitedRows.push_back(i);
+            const float *row = cost.data() + (size_t)i * m;
+            double base = minVal - u[i];
+            double lowest = numeric_limits<double>::infinity();
+            int index = 0;
+            for (int it = 0; it < numRemaining; ++it)
+            {
+                double r = base + row[remCol[it]] - remV[it];
+                if (r < remKey[it])
+                {
+                    remKey[it] = r;
+                    path[remCol[it]] = i;
+                }
+                if (remKey[it] < lowest)
+                {
+                    lowest = remKey[it];
+                    index = it;
+                }
+            }
+            int j = remCol[index];
+            minVal = lowest;
+            spc[j] = lowest;
+            if (colToRow[j] < 0)
+                sink = j;
+            else
+                i = colToRow[j];
+            visitedCols.push_back(j);
+            --numRemaining;
+            remCol[index] = remCol[numRemaining];
+            remKey[index] = remKey[numRemaining];
+            remV[index] = remV[numRemaining];
+        }
+
+        u[start] += minVal;
+        for (int r : visitedRows)
+            if (r != start)
+                u[r] += minVal - spc[rowToCol[r]];
+        for (int c : visitedCols)
+            v[c] -= minVal - spc[c];
+
+        for (int j = sink;;)
+        {
+            int r = path[j];
+            colToRow[j] = r;
+            swap(rowToCol[r], j);
+            if (r == start)
+                break;
+        }
+    }
+};
@@ -0,0 +1,1603 @@
+// Engine microbenchmarks (headless, no raylib)
+// Build: make bench   (or g++ -std=c++17 -O2 bench.cpp -o bench -pthread)
+//
+// Usage: bench [case ...]    runs every case when none is named
+
+#include "simulation.h"
+#include "sim_thread.h"
+#include "label_cache.h"
+#include "city_gen.h"
+#include "city_file.h"
+#include "benchmarks/kinematics.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+
+// ----------------------------- Allocation counting ------------------------
+
+// Every heap allocation of the process goes through here; a case reads the
+// counter around the code it measures.
+static atomic<long long> heapAllocs{0};
+
+void *operator new(size_t n)
+{
+    heapAllocs.fetch_add(1, memory_order_relaxed);
+    if (void *p = malloc(n ? n : 1))
+        return p;
+    throw bad_alloc();
+}
+
+// kept out of line: once inlined, GCC pairs the free() with the new
+// expression and warns about a mismatch that is not there
+__attribute__((noinline)) void operator delete(void *p) noexcept { free(p); }
+__attribute__((noinline)) void operator delete(void *p, size_t) noexcept { free(p); }
+
+// ----------------------------- Helpers ------------------------------------
+
+static double nowSec()
+{
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// keeps the optimiser from discarding benchmark results
+static volatile double benchSink = 0.0;
+
+// cases that check correctness count failures here; bench exits non-zero
+static int benchFailures = 0;
+
+static CityMap gridCity(int blocks, int lots = 1)
+{
+    CityConfig cfg;
+    cfg.blocksX = cfg.blocksY = blocks;
+    cfg.lotsX = cfg.lotsY = lots;
+    cfg.seed = 1;
+    return buildGridCity(cfg);
+}
+
+// ----------------------------- Cases --------------------------------------
+
+static void benchPathfinding()
+{
+    for (int blocks : {3, 50, 500})
+    {
+        CityMap city = gridCity(blocks);
+        const RoadGraph &g = city.graph;
+        mt19937 rng(7);
+        uniform_int_distribution<int> pick(0, g.nodeCount() - 1);
+        int queries = blocks <= 3 ? 1000000 : (blocks <= 50 ? 20000 : 200);
+        vector<int> nodes;
+        double total = 0.0;
+        double t0 = nowSec();
+        for (int q = 0; q < queries; ++q)
+            total += g.shortestPath(pick(rng), pick(rng), nodes);
+        double dt = nowSec() - t0;
+        benchSink = benchSink + total;
+        printf("pathfinding  %3dx%-3d grid  %7d nodes  %8d queries  %10.1f ns/query\n",
+               blocks, blocks, g.nodeCount(), queries, dt * 1e9 / queries);
+    }
+}
+
+// Nearest-intersection scan the simulation used before RoadSnapper, kept as
+// the baseline.
+static Vec2 legacyNearestRoadPoint(Vec2 target, const CityConfig &c)
+{
+    float minDist = 1e9f;
+    Vec2 nearest = target;
+    for (int y = 0; y <= c.blocksY; ++y)
+        for (int x = 0; x <= c.blocksX; ++x)
+        {
+            Vec2 inter = {c.startX + x * c.blockSize, c.startY + y * c.blockSize};
+            float dx = target.x - inter.x, dy = target.y - inter.y;
+            float d = sqrtf(dx * dx + dy * dy);
+            if (d < minDist)
+            {
+                minDist = d;
+                nearest = inter;
+            }
+        }
+    return nearest;
+}
+
+static void benchSnapping()
+{
+    const int queries = 1000000;
+    for (int blocks : {3, 100})
+    {
+        CityMap city = gridCity(blocks);
+        const CityConfig &c = city.cfg;
+        mt19937 rng(11);
+        uniform_real_distribution<float> px(c.startX - 50, c.startX + city.mapWidth);
+        uniform_real_distribution<float> py(c.startY - 50, c.startY + city.mapHeight);
+        vector<Vec2> pts(queries);
+        for (auto &p : pts)
+            p = {px(rng), py(rng)};
+
+        int legacyQueries = blocks <= 3 ? queries : queries / 100;
+        double t0 = nowSec();
+        double acc = 0.0;
+        for (int q = 0; q < legacyQueries; ++q)
+            acc += legacyNearestRoadPoint(pts[q], c).x;
+        double tLegacy = (nowSec() - t0) / legacyQueries;
+
+        t0 = nowSec();
+        for (auto &p : pts)
+            acc += city.snapper.nearest(p);
+        double tSnap = (nowSec() - t0) / queries;
+        benchSink = benchSink + acc;
+
+        int mismatches = 0;
+        for (int q = 0; q < legacyQueries; ++q)
+        {
+            Vec2 a = legacyNearestRoadPoint(pts[q], c), b = city.graph.position(city.snapper.nearest(pts[q]));
+            float da = hypotf(a.x - pts[q].x, a.y - pts[q].y), db = hypotf(b.x - pts[q].x, b.y - pts[q].y);
+            mismatches += fabsf(da - db) > 1e-3f;
+        }
+        printf("snapping     %3dx%-3d grid  %-9s legacy scan %9.1f ns  snapper %6.1f ns  (%d mismatches)\n",
+               blocks, blocks, city.snapper.isRegular() ? "lattice" : "hashed", tLegacy * 1e9, tSnap * 1e9, mismatches);
+    }
+
+    // irregular map: jittered intersections force the spatial hash
+    mt19937 rng(13);
+    uniform_real_distribution<float> coord(0.0f, 20000.0f);
+    vector<Vec2> nodes(100000);
+    for (auto &n : nodes)
+        n = {coord(rng), coord(rng)};
+    RoadSnapper snapper(nodes);
+    vector<Vec2> pts(queries);
+    for (auto &p : pts)
+        p = {coord(rng), coord(rng)};
+    double t0 = nowSec();
+    double acc = 0.0;
+    for (auto &p : pts)
+        acc += snapper.nearest(p);
+    double tSnap = (nowSec() - t0) / queries;
+
+    const int scanQueries = 1000;
+    int mismatches = 0;
+    t0 = nowSec();
+    for (int q = 0; q < scanQueries; ++q)
+    {
+        int best = 0;
+        float bestd = numeric_limits<float>::max();
+        for (int n = 0; n < (int)nodes.size(); ++n)
+        {
+            float d = hypotf(nodes[n].x - pts[q].x, nodes[n].y - pts[q].y);
+            if (d < bestd)
+            {
+                bestd = d;
+                best = n;
+            }
+        }
+        mismatches += best != snapper.nearest(pts[q]);
+    }
+    double tScan = (nowSec() - t0) / scanQueries;
+    benchSink = benchSink + acc;
+    printf("snapping     irregular    %-9s linear scan %9.1f ns  snapper %6.1f ns  (%d mismatches, %d nodes)\n",
+           snapper.isRegular() ? "lattice" : "hashed", tScan * 1e9, tSnap * 1e9, mismatches, (int)nodes.size());
+}
+
+static void benchFleetIndex()
+{
+    CityMap city = gridCity(100);
+    Rect area = city.bounds();
+    mt19937 rng(17);
+    uniform_int_distribution<int> pickNode(0, city.graph.nodeCount() - 1);
+    uniform_real_distribution<float> px(area.x, area.x + area.width), py(area.y, area.y + area.height);
+    const int queries = 20000;
+    vector<Vec2> targets(queries);
+    for (auto &t : targets)
+        t = {px(rng), py(rng)};
+
+    for (int fleet : {100, 1000, 10000, 100000})
+    {
+        vector<Vec2> units(fleet);
+        IdleFleetIndex index;
+        index.reset(area, city.cfg.blockSize);
+        for (int i = 0; i < fleet; ++i)
+        {
+            units[i] = city.graph.position(pickNode(rng));
+            index.insert(i, units[i]);
+        }
+
+        // the linear Euclidean scan Hospital used before the index
+        double t0 = nowSec();
+        double acc = 0.0;
+        for (auto &t : targets)
+        {
+            int best = -1;
+            float bestd = numeric_limits<float>::max();
+            for (int i = 0; i < fleet; ++i)
+            {
+                float d = sqrtf((units[i].x - t.x) * (units[i].x - t.x) + (units[i].y - t.y) * (units[i].y - t.y));
+                if (d < bestd)
+                {
+                    bestd = d;
+                    best = i;
+                }
+            }
+            acc += best;
+        }
+        double tScan = (nowSec() - t0) / queries;
+
+        t0 = nowSec();
+        for (auto &t : targets)
+            acc += index.nearest(t, city.graph, city.snapper);
+        double tIndex = (nowSec() - t0) / queries;
+
+        // status churn: a unit is dispatched and another becomes idle
+        t0 = nowSec();
+        for (int q = 0; q < queries; ++q)
+        {
+            int u = q % fleet;
+            index.erase(u);
+            index.insert(u, units[u]);
+        }
+        double tUpdate = (nowSec() - t0) / queries;
+        benchSink = benchSink + acc;
+        printf("fleet index  %6d idle units  linear scan %9.1f ns  road k=1 %7.1f ns  erase+insert %5.1f ns\n",
+               fleet, tScan * 1e9, tIndex * 1e9, tUpdate * 1e9);
+    }
+}
+
+static void benchPendingView()
+{
+    for (int backlog : {100, 10000})
+    {
+        Hospital h(Vec2{0, 0}, {});
+        mt19937 rng(19);
+        uniform_int_distribution<int> prio(1, 3);
+        for (int i = 0; i < backlog; ++i)
+        {
+            Emergency em;
+            em.priority = prio(rng);
+            em.patient.name = "Patient with a long enough name " + to_string(i);
+            em.patient.severity = "Normal";
+            h.receiveEmergency(em, i * 0.01);
+        }
+
+        // what the queue panel used to do every frame: copy the whole queue and sort it
+        const int frames = backlog <= 100 ? 10000 : 100;
+        double t0 = nowSec();
+        double acc = 0.0;
+        vector<const Emergency *> top;
+        for (int f = 0; f < frames; ++f)
+        {
+            h.peekPending(backlog, top);
+            vector<Emergency> copy;
+            for (auto *e : top)
+                copy.push_back(*e);
+            acc += copy[0].id;
+        }
+        double tCopy = (nowSec() - t0) / frames;
+
+        const int views = 100000;
+        t0 = nowSec();
+        for (int f = 0; f < views; ++f)
+            acc += h.peekPending(WorldSnapshot::queuePreview, top);
+        double tTop = (nowSec() - t0) / views;
+        benchSink = benchSink + acc;
+        printf("pending view %6d waiting  full sorted copy %11.1f ns  top-%d view %6.1f ns\n",
+               backlog, tCopy * 1e9, WorldSnapshot::queuePreview, tTop * 1e9);
+    }
+}
+
+// The per-vehicle record units were kept in before FleetStore.
+struct LegacyAmbulance
+{
+    int id = 0;
+    Vec2 pos, parkingPos;
+    float speed = 150.0f;
+    Ambulance::Status status = Ambulance::Status::IDLE;
+    vector<Vec2> path;
+    int currentPathIndex = 0;
+    string assignedPatientName;
+};
+
+// Per-vehicle movement loop as it ran over vector<LegacyAmbulance>.
+static void legacyMoveAmbulances(vector<LegacyAmbulance> &ambulances, float dt)
+{
+    for (auto &amb : ambulances)
+    {
+        if (!amb.path.empty() && amb.currentPathIndex < (int)amb.path.size())
+        {
+            Vec2 t = amb.path[amb.currentPathIndex];
+            Vec2 d = {t.x - amb.pos.x, t.y - amb.pos.y};
+            float dist = sqrtf(d.x * d.x + d.y * d.y);
+            if (dist > 3.0f)
+            {
+                d.x /= dist;
+                d.y /= dist;
+                float sp = amb.speed;
+                if (amb.status == Ambulance::Status::RETURNING)
+                    sp *= 0.8f;
+                amb.pos.x += d.x * sp * dt;
+                amb.pos.y += d.y * sp * dt;
+            }
+            else
+                amb.currentPathIndex++;
+        }
+        else if (amb.status == Ambulance::Status::IDLE)
+        {
+            Vec2 tgt = amb.parkingPos;
+            float dx = tgt.x - amb.pos.x, dy = tgt.y - amb.pos.y, dist = sqrtf(dx * dx + dy * dy);
+            if (dist > 1.0f)
+            {
+                amb.pos.x += (dx / dist) * amb.speed * 0.4f * dt;
+                amb.pos.y += (dy / dist) * amb.speed * 0.4f * dt;
+            }
+        }
+    }
+}
+
+// Fleet of n units on a big grid: 60% en route, 25% returning, 15% idle.
+static vector<LegacyAmbulance> randomFleet(int n, unsigned seed)
+{
+    CityMap city = gridCity(200);
+    mt19937 rng(seed);
+    uniform_int_distribution<int> pickNode(0, city.graph.nodeCount() - 1);
+    uniform_real_distribution<float> u01(0.0f, 1.0f);
+    vector<LegacyAmbulance> fleet(n);
+    for (int i = 0; i < n; ++i)
+    {
+        LegacyAmbulance &a = fleet[i];
+        a.id = i + 1;
+        a.parkingPos = city.graph.position(pickNode(rng));
+        a.pos = city.graph.position(pickNode(rng));
+        float r = u01(rng);
+        a.status = r < 0.6f ? Ambulance::Status::TO_SCENE : (r < 0.85f ? Ambulance::Status::RETURNING : Ambulance::Status::IDLE);
+        if (a.status != Ambulance::Status::IDLE)
+            city.route(a.pos, city.graph.position(pickNode(rng)), a.path);
+        a.assignedPatientName = "Patient name past the SSO limit";
+    }
+    return fleet;
+}
+
+// The same movement stepped over structure-of-arrays lanes with the
+// kinematics.h kernel: targets and rates are re-derived only when a
+// unit reaches a waypoint.
+struct SteppedFleet
+{
+    vector<float> x, y, tx, ty, speed, rate, reach2, onRoute;
+    vector<float> parkX, parkY;
+    vector<Ambulance::Status> status;
+    vector<vector<Vec2>> path;
+    vector<int> pathIdx;
+    vector<int> arrivals;
+
+    void add(const LegacyAmbulance &a)
+    {
+        x.push_back(a.pos.x);
+        y.push_back(a.pos.y);
+        parkX.push_back(a.parkingPos.x);
+        parkY.push_back(a.parkingPos.y);
+        speed.push_back(a.speed);
+        for (auto *v : {&tx, &ty, &rate, &reach2, &onRoute})
+            v->push_back(0.0f); // set by retarget
+        status.push_back(a.status);
+        path.push_back(a.path);
+        pathIdx.push_back(a.currentPathIndex);
+        retarget((int)x.size() - 1);
+    }
+
+    // Units on a route head for the next waypoint (returning ones at 80%
+    // speed), idle units creep back onto their parking bay at 40%, everyone
+    // else holds.
+    void retarget(int i)
+    {
+        if (pathIdx[i] < (int)path[i].size())
+        {
+            tx[i] = path[i][pathIdx[i]].x;
+            ty[i] = path[i][pathIdx[i]].y;
+            rate[i] = speed[i] * (status[i] == Ambulance::Status::RETURNING ? 0.8f : 1.0f);
+            reach2[i] = 3.0f * 3.0f;
+            onRoute[i] = 1.0f;
+        }
+        else
+        {
+            tx[i] = parkX[i];
+            ty[i] = parkY[i];
+            rate[i] = status[i] == Ambulance::Status::IDLE ? speed[i] * 0.4f : 0.0f;
+            reach2[i] = 1.0f;
+            onRoute[i] = 0.0f;
+        }
+    }
+
+    void step(float dt)
+    {
+        arrivals.resize(x.size());
+        KinematicsLanes lanes = {x.data(), y.data(), tx.data(), ty.data(), rate.data(),
+                                 reach2.data(), onRoute.data(), (int)x.size()};
+        int n = integrateKinematics(lanes, dt, arrivals.data());
+        for (int k = 0; k < n; ++k)
+        {
+            pathIdx[arrivals[k]]++;
+            retarget(arrivals[k]);
+        }
+    }
+};
+
+static void benchMovement()
+{
+    const int n = 100000, ticks = 200;
+    const float dt = 1.0f / 120.0f;
+    vector<LegacyAmbulance> aos = randomFleet(n, 23);
+    SteppedFleet soa;
+    for (auto &a : aos)
+        soa.add(a);
+
+    double t0 = nowSec();
+    for (int t = 0; t < ticks; ++t)
+        legacyMoveAmbulances(aos, dt);
+    double tAos = (nowSec() - t0) / ticks;
+
+    t0 = nowSec();
+    for (int t = 0; t < ticks; ++t)
+        soa.step(dt);
+    double tSoa = (nowSec() - t0) / ticks;
+
+    float maxErr = 0.0f;
+    for (int i = 0; i < n; ++i)
+        maxErr = max(maxErr, fabsf(aos[i].pos.x - soa.x[i]) + fabsf(aos[i].pos.y - soa.y[i]));
+    printf("movement     %d vehicles  AoS %8.3f ms/tick  SoA/%s %8.3f ms/tick  (%.1fx, %.1f Mveh/s, max drift %.4f)\n",
+           n, tAos * 1e3, kinematicsKernelName(), tSoa * 1e3, tAos / tSoa, n / tSoa * 1e-6, maxErr);
+}
+
+static void benchNetworkRouting()
+{
+    CityMap city = gridCity(100);
+    Rect area = city.bounds();
+    mt19937 rng(23);
+    uniform_real_distribution<float> px(area.x, area.x + area.width), py(area.y, area.y + area.height);
+    uniform_int_distribution<int> backlog(0, 6);
+    const int queries = 200000;
+    vector<Vec2> calls(queries);
+    for (auto &c : calls)
+        c = {px(rng), py(rng)};
+
+    for (int count : {32, 256, 4096})
+    {
+        vector<Hospital> hospitals;
+        for (int i = 0; i < count; ++i)
+        {
+            Vec2 loc = {px(rng), py(rng)};
+            hospitals.emplace_back(loc, vector<Vec2>(4, loc));
+            // uneven load so the scores differ from plain distance
+            for (int b = backlog(rng); b > 0; --b)
+                hospitals.back().receiveEmergency(Emergency{}, 0.0);
+        }
+        HospitalNetwork network;
+        network.rebuild(hospitals);
+
+        // score every hospital for every call
+        double t0 = nowSec();
+        double acc = 0.0;
+        for (auto &c : calls)
+        {
+            int best = -1;
+            float bestTime = numeric_limits<float>::infinity();
+            for (int h = 0; h < count; ++h)
+            {
+                float t = HospitalNetwork::estimateResponse(hospitals[h], c);
+                if (t < bestTime)
+                {
+                    bestTime = t;
+                    best = h;
+                }
+            }
+            acc += best;
+        }
+        double tScan = (nowSec() - t0) / queries;
+
+        t0 = nowSec();
+        for (auto &c : calls)
+            acc += network.route(hospitals, c);
+        double tRoute = (nowSec() - t0) / queries;
+        benchSink = benchSink + acc;
+        printf("network      %4d hospitals  score all %8.1f ns  k-d tree %d nearest %6.1f ns\n",
+               count, tScan * 1e9, HospitalNetwork::candidates, tRoute * 1e9);
+    }
+}
+
+static void benchAssignment()
+{
+    CityMap city = gridCity(100);
+    mt19937 rng(29);
+    uniform_int_distribution<int> pickNode(0, city.graph.nodeCount() - 1);
+    uniform_int_distribution<int> prio(1, 3);
+    uniform_real_distribution<float> uniformCost(0.0f, 1000.0f);
+    AssignmentSolver solver;
+    vector<int> match;
+
+    // uniform random costs, the textbook stress case
+    {
+        const int n = 500, reps = 20;
+        vector<float> cost((size_t)n * n);
+        double t = 0.0;
+        for (int r = 0; r < reps; ++r)
+        {
+            for (auto &c : cost)
+                c = uniformCost(rng);
+            double t0 = nowSec();
+            benchSink = benchSink + solver.solve(cost, n, n, match);
+            t += nowSec() - t0;
+        }
+        printf("assignment   random %dx%d  %7.2f ms/solve\n", n, n, t / reps * 1e3);
+    }
+
+    // dispatcher instances: calls and idle units spread over the city, cost
+    // = urgency weight x travel, as Hospital::dispatchBatch builds it
+    for (int n : {40, 500})
+    {
+        const int reps = n <= 40 ? 200 : 20;
+        double t = 0.0, greedyCost = 0.0, optimalCost = 0.0;
+        for (int r = 0; r < reps; ++r)
+        {
+            vector<Vec2> units(n), calls(n);
+            vector<int> prios(n);
+            for (int i = 0; i < n; ++i)
+            {
+                units[i] = city.graph.position(pickNode(rng));
+                Vec2 c = city.graph.position(pickNode(rng));
+                calls[i] = {c.x + 30.0f, c.y + 25.0f};
+                prios[i] = prio(rng);
+            }
+            sort(prios.begin(), prios.end()); // calls come in dispatch order
+            vector<float> cost((size_t)n * n);
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j)
+                    cost[(size_t)i * n + j] = Hospital::priorityWeight(prios[i]) * Hospital::travelEstimate(units[j], calls[i]);
+
+            double t0 = nowSec();
+            optimalCost += solver.solve(cost, n, n, match);
+            t += nowSec() - t0;
+
+            // greedy: each call in turn takes the cheapest unit left
+            vector<char> taken(n, 0);
+            for (int i = 0; i < n; ++i)
+            {
+                int best = -1;
+                for (int j = 0; j < n; ++j)
+                    if (!taken[j] && (best < 0 || cost[(size_t)i * n + j] < cost[(size_t)i * n + best]))
+                        best = j;
+                taken[best] = 1;
+                greedyCost += cost[(size_t)i * n + best];
+            }
+        }
+        printf("assignment   surge %3d calls x %3d units  %7.2f ms/solve  weighted travel: greedy %.0f  optimal %.0f (-%.1f%%)\n",
+               n, n, t / reps * 1e3, greedyCost / reps, optimalCost / reps, 100.0 * (1.0 - optimalCost / greedyCost));
+    }
+}
+
+// Optimality of AssignmentSolver against brute force on small random
+// problems, square and with spare columns. Narrow integer costs give many
+// ties, the case most likely to trip the augmentation.
+static void benchAssignmentCheck()
+{
+    mt19937 rng(31);
+    AssignmentSolver solver;
+    vector<int> match;
+    vector<double> best;
+    const int problems = 20000;
+    int wrong = 0;
+    for (int p = 0; p < problems; ++p)
+    {
+        int n = uniform_int_distribution<int>(1, 8)(rng);
+        int m = n + uniform_int_distribution<int>(0, 3)(rng);
+        bool ties = p % 2;
+        uniform_real_distribution<float> wide(0.0f, 1000.0f);
+        uniform_int_distribution<int> narrow(0, 4);
+        vector<float> cost((size_t)n * m);
+        for (auto &c : cost)
+            c = ties ? (float)narrow(rng) : wide(rng);
+
+        double total = solver.solve(cost, n, m, match);
+
+        // best[mask]: cheapest way to give the first popcount(mask) rows the
+        // columns in mask
+        best.assign((size_t)1 << m, numeric_limits<double>::infinity());
+        best[0] = 0.0;
+        double optimum = numeric_limits<double>::infinity();
+        for (unsigned mask = 0; mask < best.size(); ++mask)
+        {
+            int row = __builtin_popcount(mask);
+            if (best[mask] == numeric_limits<double>::infinity())
+                continue;
+            if (row == n)
+            {
+                optimum = min(optimum, best[mask]);
+                continue;
+            }
+            for (int j = 0; j < m; ++j)
+                if (!(mask >> j & 1u))
+                    best[mask | 1u << j] = min(best[mask | 1u << j], best[mask] + cost[(size_t)row * m + j]);
+        }
+
+        // the matching must be one column per row and add up to the total
+        vector<char> used(m, 0);
+        double sum = 0.0;
+        bool valid = (int)match.size() == n;
+        for (int i = 0; valid && i < n; ++i)
+        {
+            int j = match[i];
+            valid = j >= 0 && j < m && !used[j];
+            if (valid)
+            {
+                used[j] = 1;
+                sum += cost[(size_t)i * m + j];
+            }
+        }
+        double tol = 1e-3 * (1.0 + fabs(optimum));
+        wrong += !valid || fabs(sum - total) > tol || fabs(total - optimum) > tol;
+    }
+    printf("assignment   check %d random problems up to 8x11 against brute force: %d wrong\n", problems, wrong);
+    benchFailures += wrong > 0;
+}
+
+// Stress for the intake ring: call-taker threads push at a combined target
+// rate while one consumer drains once per 1/120 s tick, as the simulation
+// does. Checks that every call arrives exactly once and in per-thread order.
+static void benchIntake()
+{
+    const int producers = 16;
+    const double rate = 1e6, seconds = 2.0;
+    const double tick = 1.0 / 120.0;
+    IntakeQueue<IntakeItem> ring(1 << 16);
+    atomic<bool> go{false};
+    atomic<long long> fullRetries{0};
+    const long long perThread = (long long)(rate * seconds / producers);
+
+    vector<thread> threads;
+    for (int p = 0; p < producers; ++p)
+        threads.emplace_back([&, p]()
+        {
+            while (!go.load(memory_order_acquire))
+                this_thread::yield();
+            double start = nowSec();
+            long long retries = 0;
+            for (long long i = 0; i < perThread; ++i)
+            {
+                // pace to this thread's share of the target rate
+                while ((nowSec() - start) * (rate / producers) < i)
+                    this_thread::yield();
+                IntakeItem item;
+                item.em.priority = 1 + (int)(i % 3);
+                item.em.patient.houseNumber = p;      // producer
+                item.em.patient.age = (int)i;         // sequence within producer
+                item.em.patient.name = "Caller";
+                while (!ring.tryPush(move(item)))
+                {
+                    retries++;
+                    this_thread::yield();
+                }
+            }
+            fullRetries += retries;
+        });
+
+    vector<long long> nextSeq(producers, 0);
+    long long received = 0, outOfOrder = 0;
+    int maxPerTick = 0, ticks = 0;
+    double drainTime = 0.0, maxDrain = 0.0;
+    double t0 = nowSec();
+    go.store(true, memory_order_release);
+    const long long total = perThread * producers;
+    while (received < total)
+    {
+        double due = t0 + (ticks + 1) * tick;
+        while (nowSec() < due)
+            this_thread::yield();
+        double d0 = nowSec();
+        int n = ring.drain([&](IntakeItem &it)
+        {
+            int p = it.em.patient.houseNumber;
+            if (it.em.patient.age != nextSeq[p])
+                outOfOrder++;
+            nextSeq[p] = it.em.patient.age + 1;
+        }, (int)ring.capacity());
+        double d = nowSec() - d0;
+        drainTime += d;
+        maxDrain = max(maxDrain, d);
+        received += n;
+        maxPerTick = max(maxPerTick, n);
+        ticks++;
+    }
+    double wall = nowSec() - t0;
+    for (auto &t : threads)
+        t.join();
+    printf("intake       %d threads  %lld calls in %.2f s (%.2f M/s, target %.2f M/s)  ring %zu\n",
+           producers, received, wall, received / wall * 1e-6, rate * 1e-6, ring.capacity());
+    printf("intake       drain/tick avg %.3f ms max %.3f ms, max %d calls/tick, %lld full-ring retries, %lld out of order\n",
+           drainTime / ticks * 1e3, maxDrain * 1e3, maxPerTick, fullRetries.load(), outOfOrder);
+
+    // unpaced: how fast the ring itself goes with every producer pushing flat out
+    IntakeQueue<IntakeItem> fast(1 << 16);
+    const long long flatOut = 4000000 / producers;
+    vector<thread> burst;
+    atomic<bool> start{false};
+    for (int p = 0; p < producers; ++p)
+        burst.emplace_back([&]()
+        {
+            while (!start.load(memory_order_acquire))
+                this_thread::yield();
+            for (long long i = 0; i < flatOut; ++i)
+            {
+                IntakeItem item;
+                while (!fast.tryPush(move(item)))
+                    this_thread::yield();
+            }
+        });
+    long long got = 0;
+    t0 = nowSec();
+    start.store(true, memory_order_release);
+    while (got < flatOut * producers)
+    {
+        int n = fast.drain([](IntakeItem &) {}, 1 << 16);
+        got += n;
+        if (n == 0)
+            this_thread::yield();
+    }
+    wall = nowSec() - t0;
+    for (auto &t : burst)
+        t.join();
+    printf("intake       flat out: %lld calls in %.2f s (%.1f M/s)\n", got, wall, got / wall * 1e-6);
+
+    // end to end: threads post into a live Simulation while it steps
+    Simulation sim(gridCity(20));
+    placeHospitalGrid(sim, 16, 8);
+    const int perPoster = 10000;
+    const FlatArray<House> &houses = sim.map().houses;
+    vector<thread> posters;
+    atomic<int> rejected{0};
+    for (int p = 0; p < producers; ++p)
+        posters.emplace_back([&, p]()
+        {
+            for (int i = 0; i < perPoster; ++i)
+            {
+                Emergency em;
+                em.priority = 1 + i % 3;
+                em.location = houses[(p * perPoster + i) % houses.size()].frontDoor();
+                while (sim.post(em) < 0)
+                {
+                    rejected++;
+                    this_thread::yield();
+                }
+            }
+        });
+    t0 = nowSec();
+    long long steps = 0;
+    while (sim.emergencyCount() < producers * perPoster)
+    {
+        sim.step();
+        steps++;
+    }
+    wall = nowSec() - t0;
+    for (auto &t : posters)
+        t.join();
+    printf("intake       simulation: %d posted calls submitted over %lld ticks in %.2f s (%d ring-full retries)\n",
+           sim.emergencyCount(), steps, wall, rejected.load());
+}
+
+// Simulation on its own thread while a deliberately slow "renderer" (50 ms
+// per frame, 20 fps) reads snapshots and posts a call every frame. The tick
+// rate and the post-to-dispatch latency must not depend on the frame time.
+static void benchThreaded()
+{
+    Simulation sim(gridCity(20));
+    placeHospitalGrid(sim, 16, 8);
+    const FlatArray<House> &houses = sim.map().houses;
+    SimulationThread runner(sim);
+    const int frames = 40;
+    const double frameTime = 0.050;
+
+    runner.start();
+    double t0 = nowSec(), latencySum = 0.0, latencyMax = 0.0;
+    long long ageSum = 0, ageMax = 0;
+    int posted = 0;
+    for (int f = 0; f < frames; ++f)
+    {
+        const WorldSnapshot &frame = runner.latest();
+        long long age = runner.ticks() - frame.tick;
+        ageSum += age;
+        ageMax = max(ageMax, age);
+
+        Emergency em;
+        em.location = houses[(f * 37) % houses.size()].frontDoor();
+        double p0 = nowSec();
+        sim.post(em);
+        posted++;
+        // wait for the call to show up in a published snapshot
+        while (runner.latest().totalEmergencies < posted)
+            this_thread::yield();
+        double lat = nowSec() - p0;
+        latencySum += lat;
+        latencyMax = max(latencyMax, lat);
+
+        this_thread::sleep_for(chrono::duration<double>(frameTime)); // the slow draw
+    }
+    double wall = nowSec() - t0;
+    runner.stop();
+    printf("threaded     render %.0f fps: sim %.1f ticks/s (%lld late), snapshot age avg %.2f max %lld ticks,"
+           " post->dispatched avg %.2f ms max %.2f ms (single-threaded: up to one frame, %.0f ms)\n",
+           1.0 / frameTime, runner.ticks() / wall, runner.lateTicks(), (double)ageSum / frames, ageMax,
+           latencySum / frames * 1e3, latencyMax * 1e3, frameTime * 1e3);
+}
+
+// SimClock pacing on the simulation thread: the sim speed reached at each
+// multiplier, steps dropped when it cannot keep up, pause and single steps.
+// The state after a paced run must hash the same as the same number of
+// steps run in a plain loop.
+static void benchClock()
+{
+    auto fill = [](Simulation &sim)
+    {
+        placeHospitalGrid(sim, 16, 8);
+        const FlatArray<House> &houses = sim.map().houses;
+        for (int i = 0; i < 200; ++i)
+        {
+            Emergency em;
+            em.priority = 1 + i % 3;
+            em.location = houses[(i * 37) % houses.size()].frontDoor();
+            sim.submit(em);
+        }
+    };
+    for (double speed : {1.0, 100.0, 1000.0, 10000.0})
+    {
+        Simulation sim(gridCity(20));
+        fill(sim);
+        SimulationThread runner(sim);
+        runner.clock().setSpeed(speed);
+        double t0 = nowSec();
+        runner.start();
+        this_thread::sleep_for(chrono::milliseconds(500));
+        runner.stop();
+        double wall = nowSec() - t0;
+        long long ticks = sim.ticks();
+        uint64_t paced = sim.stateHash();
+        Simulation plain(gridCity(20));
+        fill(plain);
+        while (plain.ticks() < ticks)
+            plain.step();
+        printf("clock        %6.0fx: sim ran %8.1fx real time, %lld ticks, %lld dropped, %s\n", speed, sim.time() / wall,
+               ticks, runner.lateTicks(), plain.stateHash() == paced ? "same state as a plain loop" : "STATE DIFFERS");
+    }
+    Simulation sim(gridCity(20));
+    fill(sim);
+    SimulationThread runner(sim);
+    runner.clock().setPaused(true);
+    runner.start();
+    this_thread::sleep_for(chrono::milliseconds(100));
+    long long before = runner.ticks();
+    runner.clock().stepOnce(5);
+    this_thread::sleep_for(chrono::milliseconds(100));
+    long long after = runner.ticks();
+    runner.stop();
+    printf("clock        paused: %lld ticks, +%lld after five single steps\n", before, after - before);
+}
+
+// Per-tick cost against fleet size with a fixed call rate, and runUntil's
+// skipping of quiet ticks against stepping every one.
+static void benchEvents()
+{
+    const double rate = 2.0; // calls per sim second
+    for (int hospitals : {4, 64, 1024})
+    {
+        int units = 8;
+        Simulation stepped(gridCity(hospitals <= 64 ? 20 : 100));
+        Simulation skipped(gridCity(hospitals <= 64 ? 20 : 100));
+        placeHospitalGrid(stepped, hospitals, units);
+        placeHospitalGrid(skipped, hospitals, units);
+        const FlatArray<House> &houses = stepped.map().houses;
+        long long ticks = stepped.tickAt(600.0);
+        auto drive = [&](Simulation &sim, bool skip)
+        {
+            mt19937 rng(9);
+            exponential_distribution<double> gap(rate);
+            double nextCall = gap(rng);
+            double t0 = nowSec();
+            while (sim.ticks() < ticks)
+            {
+                while (nextCall <= sim.time())
+                {
+                    Emergency em;
+                    em.priority = 1 + (int)(rng() % 3);
+                    em.location = houses[rng() % houses.size()].frontDoor();
+                    sim.submit(em);
+                    nextCall += gap(rng);
+                }
+                if (skip)
+                    sim.runUntil(min(ticks, sim.tickAt(nextCall)));
+                else
+                    sim.step();
+            }
+            return (nowSec() - t0) * 1e9 / ticks;
+        };
+        double stepNs = drive(stepped, false);
+        double skipNs = drive(skipped, true);
+        printf("events       %5d units: step %8.0f ns/tick, runUntil %8.0f ns/tick, %s\n", hospitals * units, stepNs,
+               skipNs, stepped.stateHash() == skipped.stateHash() ? "same state" : "STATE DIFFERS");
+    }
+}
+
+// Emergency markers as Simulation recomputed them every tick before the
+// active-incident set: every dispatched unit against every house.
+static int legacyHouseMarkers(const Simulation &sim, vector<unsigned char> &marked)
+{
+    const FlatArray<House> &houses = sim.map().houses;
+    marked.assign(houses.size(), 0);
+    int n = 0;
+    for (auto &hosp : sim.getHospitals())
+    {
+        const FleetStore &f = hosp.getFleet();
+        for (int i = 0; i < f.size(); ++i)
+            if ((f.status[i] == Ambulance::Status::TO_SCENE || f.status[i] == Ambulance::Status::ON_SCENE) && f.pathLen[i] > 0)
+            {
+                Vec2 target = f.path(i)[f.pathLen[i] - 1];
+                for (size_t h = 0; h < houses.size(); ++h)
+                {
+                    Vec2 c = houses[h].frontDoor();
+                    if (fabsf(c.x - target.x) < 5 && fabsf(c.y - target.y) < 5)
+                    {
+                        marked[h] = 1;
+                        n++;
+                    }
+                }
+            }
+    }
+    return n;
+}
+
+static void benchIncidentMarkers()
+{
+    for (int blocks : {20, 100})
+    {
+        CityConfig cfg;
+        cfg.blocksX = cfg.blocksY = blocks;
+        cfg.seed = 1;
+        Simulation sim(buildGridCity(cfg));
+        placeHospitalGrid(sim, blocks <= 20 ? 16 : 64, 8);
+        const FlatArray<House> &houses = sim.map().houses;
+        mt19937 rng(5);
+        for (int i = 0; i < 4000; ++i)
+        {
+            const House &h = houses[rng() % houses.size()];
+            Emergency em;
+            em.patient.houseNumber = h.id;
+            em.location = h.frontDoor();
+            sim.submit(em);
+        }
+        int ticks = 240;
+        double t0 = nowSec();
+        for (int t = 0; t < ticks; ++t)
+            sim.step();
+        double stepNs = (nowSec() - t0) * 1e9 / ticks;
+
+        vector<unsigned char> marked;
+        int reps = blocks <= 20 ? 20 : 2;
+        int hits = 0;
+        t0 = nowSec();
+        for (int r = 0; r < reps; ++r)
+            hits = legacyHouseMarkers(sim, marked);
+        double scanNs = (nowSec() - t0) * 1e9 / reps;
+        benchSink = benchSink + hits;
+        printf("markers      %3dx%-3d grid %7zu houses %4zu active  house scan %12.0f ns/tick  whole step %10.0f ns/tick\n",
+               blocks, blocks, houses.size(), sim.activeIncidents().size(), scanNs, stepNs);
+    }
+}
+
+// House lookups of the GUI on a ~1M house city: by number (form submit) and
+// by point (hover). Baselines are the linear scans main.cpp used, plus a
+// hash map for the id lookup.
+static void benchHouseLookup()
+{
+    CityConfig cfg;
+    cfg.blocksX = cfg.blocksY = 409; // x 6 lots = 1.0M houses
+    cfg.seed = 1;
+    CityMap city = buildGridCity(cfg);
+    const FlatArray<House> &houses = city.houses;
+    int n = (int)houses.size();
+    mt19937 rng(9);
+    uniform_int_distribution<int> pickId(1, n);
+    Rect area = city.bounds();
+    uniform_real_distribution<float> px(area.x, area.x + area.width), py(area.y, area.y + area.height);
+
+    const int slowQueries = 200, fastQueries = 1000000;
+    long long sum = 0;
+    double t0 = nowSec();
+    for (int q = 0; q < slowQueries; ++q)
+    {
+        int id = pickId(rng);
+        for (int i = 0; i < n; ++i)
+            if (houses[i].id == id)
+            {
+                sum += i;
+                break;
+            }
+    }
+    double scanNs = (nowSec() - t0) * 1e9 / slowQueries;
+    unordered_map<int, int> byId;
+    for (int i = 0; i < n; ++i)
+        byId[houses[i].id] = i;
+    t0 = nowSec();
+    for (int q = 0; q < fastQueries; ++q)
+        sum += byId.find(pickId(rng))->second;
+    double hashNs = (nowSec() - t0) * 1e9 / fastQueries;
+    t0 = nowSec();
+    for (int q = 0; q < fastQueries; ++q)
+        sum += city.houseIndex(pickId(rng));
+    double denseNs = (nowSec() - t0) * 1e9 / fastQueries;
+    printf("house by id  %7d houses  linear scan %12.1f ns  hash map %6.1f ns  dense array %6.1f ns\n", n, scanNs, hashNs, denseNs);
+
+    int mismatches = 0, hits = 0;
+    t0 = nowSec();
+    for (int q = 0; q < slowQueries; ++q)
+    {
+        Vec2 p{px(rng), py(rng)};
+        int found = -1;
+        for (int i = 0; i < n; ++i)
+        {
+            const Rect &b = houses[i].body;
+            if (p.x >= b.x && p.x < b.x + b.width && p.y >= b.y && p.y < b.y + b.height)
+            {
+                found = i;
+                break;
+            }
+        }
+        mismatches += found != city.houseAt(p);
+    }
+    scanNs = (nowSec() - t0) * 1e9 / slowQueries;
+    t0 = nowSec();
+    for (int q = 0; q < fastQueries; ++q)
+        hits += city.houseAt(Vec2{px(rng), py(rng)}) >= 0;
+    double gridNs = (nowSec() - t0) * 1e9 / fastQueries;
+    benchSink = benchSink + sum + hits;
+    printf("house pick   %7d houses  linear scan %12.1f ns  uniform grid %6.1f ns  (%.0f%% of points on a house, %d mismatches)\n",
+           n, scanNs, gridNs, 100.0 * hits / fastQueries, mismatches);
+}
+
+// Generated cities of 1M and 10M houses: build time, then the engine on the
+// largest one (snapping, routing, picking, ticking 400 hospitals).
+static void benchCityGen()
+{
+    CityConfig cfg;
+    cfg.layout = CityLayout::GENERATED;
+    cfg.seed = 7;
+    cfg.jitter = 0.3f;
+    cfg.arterialEvery = 8;
+    cfg.deadEnds = 0.15f;
+    for (int blocks : {409, 1300})
+    {
+        cfg.blocksX = cfg.blocksY = blocks;
+        double t0 = nowSec();
+        Simulation sim(generateCity(cfg));
+        double genSec = nowSec() - t0;
+        const CityMap &city = sim.map();
+        printf("citygen      %8zu houses %5zu roads %8d intersections  built in %.2f s\n", city.houses.size(),
+               city.roads.size(), city.graph.nodeCount(), genSec);
+        if (blocks < 1300)
+            continue;
+
+        mt19937 rng(3);
+        Rect area = city.bounds();
+        uniform_real_distribution<float> px(area.x, area.x + area.width), py(area.y, area.y + area.height);
+        const int points = 1000000;
+        long long sum = 0;
+        t0 = nowSec();
+        for (int q = 0; q < points; ++q)
+            sum += city.snapper.nearest(Vec2{px(rng), py(rng)});
+        double snapNs = (nowSec() - t0) * 1e9 / points;
+        t0 = nowSec();
+        for (int q = 0; q < points; ++q)
+            sum += city.houseAt(Vec2{px(rng), py(rng)});
+        double pickNs = (nowSec() - t0) * 1e9 / points;
+        // routes of up to ~10 blocks, as a dispatch would ask for
+        vector<Vec2> route;
+        const int routes = 2000;
+        uniform_real_distribution<float> near(-10 * cfg.blockSize, 10 * cfg.blockSize);
+        t0 = nowSec();
+        for (int q = 0; q < routes; ++q)
+        {
+            Vec2 a{px(rng), py(rng)};
+            sum += (long long)city.route(a, Vec2{a.x + near(rng), a.y + near(rng)}, route);
+        }
+        double routeUs = (nowSec() - t0) * 1e6 / routes;
+        printf("citygen      snap %.0f ns  pick %.0f ns  10-block route %.1f us\n", snapNs, pickNs, routeUs);
+
+        placeHospitalGrid(sim, 400, 8);
+        const FlatArray<House> &houses = city.houses;
+        for (int i = 0; i < 2000; ++i)
+        {
+            const House &h = houses[rng() % houses.size()];
+            Emergency em;
+            em.patient.houseNumber = h.id;
+            em.location = h.frontDoor();
+            sim.submit(em);
+        }
+        int ticks = 1200;
+        t0 = nowSec();
+        for (int t = 0; t < ticks; ++t)
+            sim.step();
+        double tickUs = (nowSec() - t0) * 1e6 / ticks;
+        benchSink = benchSink + sum;
+        printf("citygen      400 hospitals x 8 units, 2000 calls: %.1f us/tick, %zu houses with a unit on the way\n", tickUs,
+               sim.activeIncidents().size());
+    }
+}
+
+// The 10M-house metro city written to a city file and mapped back: save
+// and load time against generating it, and the mapped copy must answer
+// snaps, picks and routes exactly as the generated one does.
+static void benchCityFile()
+{
+    CityConfig cfg;
+    cfg.layout = CityLayout::GENERATED;
+    cfg.seed = 7;
+    cfg.blocksX = cfg.blocksY = 1300;
+    cfg.jitter = 0.3f;
+    cfg.arterialEvery = 8;
+    cfg.deadEnds = 0.15f;
+    double t0 = nowSec();
+    CityMap built = generateCity(cfg);
+    double genSec = nowSec() - t0;
+    Simulation sim(built);
+    placeHospitalGrid(sim, 400, 8);
+
+    const char *path = "bench_city.tmp";
+    string error;
+    t0 = nowSec();
+    bool saved = saveCityFile(path, built, hospitalSites(sim), error);
+    double saveSec = nowSec() - t0;
+    CityMap mapped;
+    vector<HospitalSite> sites;
+    t0 = nowSec();
+    bool loaded = saved && loadCityFile(path, mapped, sites, error);
+    double loadSec = nowSec() - t0;
+    if (!loaded)
+    {
+        printf("cityfile     %s\n", error.c_str());
+        remove(path);
+        return;
+    }
+    t0 = nowSec();
+    Simulation fromFile(mapped);
+    addHospitals(fromFile, sites);
+    double readySec = nowSec() - t0;
+
+    mt19937 rng(5);
+    Rect area = built.bounds();
+    uniform_real_distribution<float> px(area.x, area.x + area.width), py(area.y, area.y + area.height);
+    uniform_real_distribution<float> near(-10 * cfg.blockSize, 10 * cfg.blockSize);
+    int mismatches = 0;
+    for (int q = 0; q < 200000; ++q)
+    {
+        Vec2 p{px(rng), py(rng)};
+        mismatches += built.snapper.nearest(p) != mapped.snapper.nearest(p);
+        mismatches += built.houseAt(p) != mapped.houseAt(p);
+    }
+    vector<Vec2> a, b;
+    for (int q = 0; q < 500; ++q)
+    {
+        Vec2 from{px(rng), py(rng)}, to{from.x + near(rng), from.y + near(rng)};
+        mismatches += built.route(from, to, a) != mapped.route(from, to, b) || a.size() != b.size();
+    }
+    printf("cityfile     %zu houses: generate %.2f s  save %.2f s  map %.1f ms  simulation ready %.1f ms\n",
+           mapped.houses.size(), genSec, saveSec, loadSec * 1e3, readySec * 1e3);
+    printf("cityfile     %zu hospitals restored, %d mismatches against the generated city\n", sites.size(), mismatches);
+    remove(path);
+}
+
+// All-pairs distance table against A*: build, cache and map time, lookup
+// against search cost, quantization error, next-hop routes, and the idle
+// unit query dispatch runs with and without the table.
+static void benchDistances()
+{
+    CityConfig generated;
+    generated.layout = CityLayout::GENERATED;
+    generated.seed = 3;
+    generated.blocksX = generated.blocksY = 60;
+    generated.jitter = 0.3f;
+    generated.arterialEvery = 8;
+    generated.deadEnds = 0.15f;
+    vector<pair<const char *, CityMap>> cities;
+    cities.push_back({"grid 20", gridCity(20)});
+    cities.push_back({"grid 60", gridCity(60)});
+    cities.push_back({"gen 60", generateCity(generated)});
+    for (auto &[name, city] : cities)
+    {
+        const RoadGraph &g = city.graph;
+        string error;
+        double t0 = nowSec();
+        DistanceTable built;
+        if (!built.build(g, 0, error))
+        {
+            printf("distances    %s: %s\n", name, error.c_str());
+            continue;
+        }
+        double buildSec = nowSec() - t0;
+        const char *path = "bench_distances.tmp";
+        t0 = nowSec();
+        bool saved = built.save(path, error);
+        double saveSec = nowSec() - t0;
+        DistanceTable table;
+        t0 = nowSec();
+        bool mapped = saved && table.load(path, g, error);
+        double loadSec = nowSec() - t0;
+        if (!mapped)
+        {
+            printf("distances    %s: %s\n", name, error.c_str());
+            continue;
+        }
+
+        mt19937 rng(21);
+        uniform_int_distribution<int> pick(0, g.nodeCount() - 1);
+        const int pairs = 2000;
+        vector<pair<int, int>> queries(pairs);
+        for (auto &q : queries)
+            q = {pick(rng), pick(rng)};
+        vector<int> nodes;
+        vector<float> exact(pairs);
+        t0 = nowSec();
+        for (int q = 0; q < pairs; ++q)
+            exact[q] = g.shortestPath(queries[q].first, queries[q].second, nodes);
+        double astarNs = (nowSec() - t0) * 1e9 / pairs;
+        double sum = 0.0;
+        const int reps = 200;
+        t0 = nowSec();
+        for (int r = 0; r < reps; ++r)
+            for (auto &q : queries)
+                sum += table.distance(q.first, q.second);
+        double lookupNs = (nowSec() - t0) * 1e9 / (pairs * reps);
+        float maxErr = 0.0f;
+        int badRoutes = 0;
+        for (int q = 0; q < pairs; ++q)
+        {
+            auto [a, b] = queries[q];
+            float d = table.distance(a, b);
+            if ((d < 0) != (exact[q] < 0))
+            {
+                badRoutes++;
+                continue;
+            }
+            maxErr = max(maxErr, fabsf(d - exact[q]));
+            // the next-hop route must be a path of the exact length
+            table.path(g, a, b, nodes);
+            float len = 0.0f;
+            for (size_t k = 0; k + 1 < nodes.size(); ++k)
+                len += hypotf(g.position(nodes[k + 1]).x - g.position(nodes[k]).x,
+                              g.position(nodes[k + 1]).y - g.position(nodes[k]).y);
+            badRoutes += d >= 0 && (nodes.empty() || nodes.back() != b || fabsf(len - exact[q]) > 0.01f * exact[q] + 0.1f);
+        }
+
+        // greedy dispatch's nearest idle unit, 1000 idle units
+        Rect area = city.bounds();
+        IdleFleetIndex index;
+        index.reset(area, city.cfg.blockSize);
+        vector<int> unitNode(1000);
+        for (int i = 0; i < 1000; ++i)
+        {
+            unitNode[i] = pick(rng);
+            index.insert(i, g.position(unitNode[i]));
+        }
+        uniform_real_distribution<float> px(area.x, area.x + area.width), py(area.y, area.y + area.height);
+        vector<Vec2> targets(2000);
+        for (auto &t : targets)
+            t = {px(rng), py(rng)};
+        int worse = 0;
+        t0 = nowSec();
+        for (auto &t : targets)
+            sum += index.nearest(t, g, city.snapper);
+        double nearestAstarNs = (nowSec() - t0) * 1e9 / targets.size();
+        t0 = nowSec();
+        for (auto &t : targets)
+            sum += index.nearest(t, g, city.snapper, &table);
+        double nearestTableNs = (nowSec() - t0) * 1e9 / targets.size();
+        // picks may differ between equally near units; count those farther away
+        for (auto &t : targets)
+        {
+            int goal = city.snapper.nearest(t);
+            float a = g.shortestPath(unitNode[index.nearest(t, g, city.snapper)], goal, nodes);
+            float b = g.shortestPath(unitNode[index.nearest(t, g, city.snapper, &table)], goal, nodes);
+            worse += b > a + 1.0f;
+        }
+        benchSink = benchSink + sum;
+        remove(path);
+        printf("distances    %-7s %5d nodes %7.1f MB  build %6.2f s  save %5.3f s  map %7.5f s\n", name, g.nodeCount(),
+               table.bytes() / 1e6, buildSec, saveSec, loadSec);
+        printf("distances    %-7s A* %8.0f ns  lookup %5.1f ns  max error %.2f px  %d bad routes  "
+               "nearest unit %6.0f -> %4.0f ns, %d of %zu picks farther\n",
+               name, astarNs, lookupNs, maxErr, badRoutes, nearestAstarNs, nearestTableNs, worse, targets.size());
+    }
+}
+
+// Cost of a profiler zone: off, recording as a scope, and as one stage of a
+// sequence, with the timestamp read on its own for scale. The collect()
+// that drains the ring runs outside the timed loops.
+static void benchProfiler()
+{
+    Profiler &prof = Profiler::instance();
+    const int chunk = profiler::Ring::capacity / 4, rounds = 400; // a ring never fills between collects
+    auto timed = [&](auto &&body)
+    {
+        double total = 0.0;
+        for (int r = 0; r < rounds; ++r)
+        {
+            double t0 = nowSec();
+            for (int i = 0; i < chunk; ++i)
+                body(i);
+            total += nowSec() - t0;
+            prof.collect();
+        }
+        return total * 1e9 / ((double)rounds * chunk);
+    };
+    uint64_t sum = 0;
+    double stampNs = timed([&](int) { sum += profiler::now(); });
+    Profiler::enable(false);
+    double offNs = timed([&](int i) { PROFILE_ZONE("bench.off"); sum += i; });
+    Profiler::enable(true);
+    double scopeNs = timed([&](int i) { PROFILE_ZONE("bench.scope"); sum += i; });
+    double stageNs = timed([&](int i)
+    {
+        profiler::Sequence seq;
+        PROFILE_NEXT(seq, "bench.stageA");
+        sum += i;
+        PROFILE_NEXT(seq, "bench.stageB");
+        sum += i;
+    }) / 2;
+    double t0 = nowSec();
+    for (int i = 0; i < chunk; ++i)
+    {
+        PROFILE_ZONE("bench.collect");
+    }
+    double c0 = nowSec();
+    prof.collect();
+    double collectNs = (nowSec() - c0) * 1e9 / chunk;
+    benchSink = benchSink + (double)sum + t0;
+    Profiler::enable(false);
+    printf("profiler     timestamp %.1f ns  zone off %.1f ns  zone %.1f ns  sequence stage %.1f ns  collect %.1f ns/event  (%lld lost)\n",
+           stampNs, offNs, scopeNs, stageNs, collectNs, prof.lostEvents());
+}
+
+// Metric updates: a sharded counter against one shared atomic, from one
+// and from four threads; a histogram record; merging a snapshot; the
+// histogram's worst relative quantile error over a wide distribution; and
+// what attaching SimMetrics adds to a busy simulation step.
+static void benchMetrics()
+{
+    const int ops = 4 << 20;
+    Counter counter;
+    atomic<uint64_t> shared{0};
+    auto threaded = [&](int threads, auto &&body)
+    {
+        double t0 = nowSec();
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t)
+            workers.emplace_back([&]() { for (int i = 0; i < ops / threads; ++i) body(i); });
+        for (auto &w : workers)
+            w.join();
+        return (nowSec() - t0) * 1e9 / ops;
+    };
+    double counterNs = threaded(1, [&](int) { counter.add(); });
+    double sharedNs = threaded(1, [&](int) { shared.fetch_add(1, memory_order_relaxed); });
+    double counter4Ns = threaded(4, [&](int) { counter.add(); });
+    double shared4Ns = threaded(4, [&](int) { shared.fetch_add(1, memory_order_relaxed); });
+
+    Histogram hist;
+    mt19937 rng(7);
+    lognormal_distribution<double> latency(12.0, 1.5); // microseconds, median ~2.7 min
+    vector<uint64_t> values(1 << 16);
+    for (auto &v : values)
+        v = (uint64_t)latency(rng);
+    double t0 = nowSec();
+    for (int i = 0; i < ops; ++i)
+        hist.record(values[i & (values.size() - 1)]);
+    double recordNs = (nowSec() - t0) * 1e9 / ops;
+    HistogramSnapshot snap;
+    t0 = nowSec();
+    for (int i = 0; i < 100; ++i)
+    {
+        snap = HistogramSnapshot{};
+        hist.snapshot(snap);
+    }
+    double snapshotUs = (nowSec() - t0) * 1e6 / 100;
+    sort(values.begin(), values.end());
+    double worstError = 0.0;
+    for (double q : {0.5, 0.9, 0.99, 0.999})
+    {
+        double exact = (double)values[(size_t)ceil(q * values.size()) - 1];
+        worstError = max(worstError, fabs(snap.quantile(q) - exact) / exact);
+    }
+
+    auto stepCost = [&](bool withMetrics)
+    {
+        Simulation sim(gridCity(20));
+        placeHospitalGrid(sim, 16, 6);
+        MetricsRegistry registry;
+        SimMetrics m(registry);
+        if (withMetrics)
+            sim.attachMetrics(&m);
+        const FlatArray<House> &houses = sim.map().houses;
+        const int ticks = 20000;
+        double start = nowSec();
+        for (int t = 0; t < ticks; ++t)
+        {
+            if (t % 4 == 0)
+            {
+                Emergency em;
+                em.priority = 1 + t % 3;
+                const House &h = houses[(t * 7919) % houses.size()];
+                em.patient.houseNumber = h.id;
+                em.location = h.frontDoor();
+                sim.submit(em);
+            }
+            sim.step();
+        }
+        benchSink = benchSink + sim.stateHash();
+        return (nowSec() - start) * 1e6 / ticks;
+    };
+    double plainUs = stepCost(false), meteredUs = stepCost(true);
+    benchSink = benchSink + (double)counter.value() + (double)shared.load() + snap.mean();
+    printf("metrics      counter %.1f ns (shared atomic %.1f)  4 threads %.1f ns (%.1f)  histogram %.1f ns  snapshot %.1f us\n",
+           counterNs, sharedNs, counter4Ns, shared4Ns, recordNs, snapshotUs);
+    printf("metrics      quantile error <= %.2f %%  step %.2f us -> %.2f us with metrics attached\n", worstError * 100,
+           plainUs, meteredUs);
+}
+
+// stands in for raylib's MeasureText
+static int approxMeasureText(const char *text, int fontSize) { return (int)strlen(text) * fontSize / 2; }
+
+// The GUI's per-frame labels over a busy 16-hospital snapshot: the string
+// building the draw loop used to do, against HudLabels. A frame whose
+// snapshot did not change must make no heap allocation.
+static void benchLabels()
+{
+    Simulation sim(gridCity(20));
+    placeHospitalGrid(sim, 16, 8);
+    const FlatArray<House> &houses = sim.map().houses;
+    for (int i = 0; i < 400; ++i)
+    {
+        Emergency em;
+        em.priority = 1 + i % 3;
+        em.patient.name = "Patient " + to_string(i);
+        em.patient.severity = i % 3 == 0 ? "Critical" : "Normal";
+        em.patient.houseNumber = houses[(i * 37) % houses.size()].id;
+        em.location = houses[(i * 37) % houses.size()].frontDoor();
+        sim.submit(em);
+    }
+    for (int t = 0; t < 600; ++t)
+        sim.step();
+    WorldSnapshot snap;
+    sim.snapshot(snap);
+    const int logRows = 5;
+
+    auto legacyFrame = [&](const WorldSnapshot &w)
+    {
+        long long width = 0;
+        for (auto &a : w.ambulances)
+        {
+            string tag = "A" + to_string(a.id) + ": " + string(a.getStatusString());
+            width += approxMeasureText(tag.c_str(), 10);
+            string title = "Ambulance #" + to_string(a.id);
+            string detail = "EN ROUTE to House #" + to_string(a.assignedHouseId);
+            width += title.size() + detail.size();
+            if (a.status == Ambulance::Status::ON_SCENE)
+                width += (to_string((int)a.onSceneTimer + 1) + "s").size();
+            if (!a.assignedPatientName.empty())
+                width += ("Patient: " + a.assignedPatientName).size();
+        }
+        for (auto &h : w.hospitals)
+        {
+            for (auto &p : h.pendingTop)
+                width += ("  #" + to_string(p.id) + " " + p.name + " (" + p.severity + ")").size();
+            width += ("  +" + to_string(h.pending) + " more...").size();
+        }
+        width += ("Total Emergencies: " + to_string(w.totalEmergencies) + " | Handled: " + to_string(1) +
+                  " | Pending: " + to_string(2)).size();
+        for (int r = 0; r < logRows; ++r)
+            width += (to_string(r * 3) + "s ago").size();
+        width += ("House #" + to_string(42) + " - Enter this number in the form").size();
+        return width;
+    };
+    HudLabels hud(approxMeasureText);
+    auto cachedFrame = [&](const WorldSnapshot &w)
+    {
+        long long width = 0;
+        for (auto &a : w.ambulances)
+        {
+            width += hud.unitTag(a).width + hud.unitTitle(a).width + hud.unitDetail(a).width;
+            if (a.status == Ambulance::Status::ON_SCENE)
+                width += hud.sceneTimer(a).width;
+            if (!a.assignedPatientName.empty())
+                width += hud.unitPatient(a).width;
+        }
+        for (size_t hi = 0; hi < w.hospitals.size(); ++hi)
+        {
+            const HospitalView &h = w.hospitals[hi];
+            for (size_t j = 0; j < h.pendingTop.size(); ++j)
+                width += hud.queueItem((int)hi, (int)j, h.pendingTop[j]).width;
+            width += hud.queueMore((int)hi, h.pending).width;
+        }
+        width += hud.totals(w.totalEmergencies, 1, 2).width;
+        for (int r = 0; r < logRows; ++r)
+            width += hud.secondsAgo(r, r * 3).width;
+        width += hud.houseHint(42).width;
+        return width;
+    };
+
+    const int frames = 2000;
+    auto measure = [&](const char *name, auto &&frame)
+    {
+        benchSink = benchSink + frame(snap); // warm-up
+        long long a0 = heapAllocs.load();
+        double t0 = nowSec();
+        for (int f = 0; f < frames; ++f)
+            benchSink = benchSink + frame(snap);
+        double dt = nowSec() - t0;
+        printf("labels       %-8s %d units %6.1f allocs/frame  %8.2f us/frame\n", name, (int)snap.ambulances.size(),
+               (double)(heapAllocs.load() - a0) / frames, dt * 1e6 / frames);
+    };
+    measure("strings", legacyFrame);
+    measure("cached", cachedFrame);
+
+    // live: two ticks per frame (120 Hz sim, 60 fps), labels rebuilt as units
+    // change state; only the label work is counted
+    long long allocs = 0, rebuilds0 = hud.labels().rebuildCount();
+    for (int f = 0; f < frames; ++f)
+    {
+        sim.step();
+        sim.step();
+        sim.snapshot(snap);
+        long long a0 = heapAllocs.load();
+        benchSink = benchSink + cachedFrame(snap);
+        allocs += heapAllocs.load() - a0;
+    }
+    printf("labels       live     %6.3f allocs/frame, %.1f labels rebuilt/frame, %zu cached\n", (double)allocs / frames,
+           (double)(hud.labels().rebuildCount() - rebuilds0) / frames, hud.labels().size());
+}
+
+// ----------------------------- Main ---------------------------------------
+
+struct BenchCase
+{
+    const char *name;
+    function<void()> run;
+};
+
+int main(int argc, char **argv)
+{
+    vector<BenchCase> cases = {
+        {"pathfinding", benchPathfinding},
+        {"snapping", benchSnapping},
+        {"fleet", benchFleetIndex},
+        {"pending", benchPendingView},
+        {"movement", benchMovement},
+        {"network", benchNetworkRouting},
+        {"assignment", benchAssignment},
+        {"assignment-check", benchAssignmentCheck},
+        {"intake", benchIntake},
+        {"threaded", benchThreaded},
+        {"clock", benchClock},
+        {"events", benchEvents},
+        {"labels", benchLabels},
+        {"markers", benchIncidentMarkers},
+        {"houses", benchHouseLookup},
+        {"citygen", benchCityGen},
+        {"cityfile", benchCityFile},
+        {"distances", benchDistances},
+        {"profiler", benchProfiler},
+        {"metrics", benchMetrics},
+    };
+    for (auto &c : cases)
+    {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i)
+            selected |= !strcmp(argv[i], c.name);
+        if (selected)
+            c.run();
+    }
+    return benchFailures ? 1 : 0;
+}
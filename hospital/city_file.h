@@ -0,0 +1,316 @@
+// Flat binary city files. The file holds every array of a built CityMap
+// (roads, houses, the id index, the house picker grid, the road graph CSR
+// and the intersection snapper) plus the hospital sites and their parking
+// bays, each as a raw array at a 64-byte aligned offset. Loading maps the
+// file and points the arrays at it: nothing is parsed or copied, so a
+// metro-scale city opens in milliseconds, and processes that map the same
+// file share its pages in the page cache.
+//
+// Layout, native byte order:
+//   CityFileHeader
+//   CityFileSection[sectionCount]   tag, element size, offset, count
+//   section data
+// Sections come in the order the classes' visitStorage functions list their
+// members, and each carries a tag, so a reader can check that it is
+// looking at what it expects. Elements are the in-memory structs, which is
+// why the header records their sizes and a byte-order marker: a file only
+// loads on a build with the same struct layout.
+//
+// The mapping is private and writable. The simulation writes a few fields of
+// the static map (House::hasEmergency, closed arcs); such a write copies
+// that one page for this process, and the file and other processes never see it.
+
+#pragma once
+
+#include "mapped_file.h"
+#include "simulation.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+struct CityFileHeader
+{
+    char magic[4];        // "EMCT"
+    uint32_t version;
+    uint32_t byteOrder;   // 0x01020304 as written
+    uint32_t sectionCount;
+    uint64_t fileSize;
+    uint32_t typeSizes[4]; // Vec2, Rect, House, Road
+};
+
+struct CityFileSection
+{
+    char tag[4];
+    uint32_t elemSize;
+    uint64_t offset;
+    uint64_t count;
+};
+
+// A hospital as stored in a city file; its bays are parking[parkingBegin ..).
+struct CityFileHospital
+{
+    Vec2 location;
+    float onSceneDuration;
+    int parkingBegin, parkingCount;
+};
+
+// A hospital to place into a Simulation.
+struct HospitalSite
+{
+    Vec2 location;
+    float onSceneDuration = 4.0f;
+    vector<Vec2> parking;
+};
+
+// ----------------------------- Format -------------------------------------
+
+namespace city_file_detail
+{
+const char magic[4] = {'E', 'M', 'C', 'T'};
+const uint32_t version = 1;
+const uint32_t byteOrder = 0x01020304;
+const uint64_t sectionAlign = 64;
+
+inline CityFileHeader expectedHeader()
+{
+    CityFileHeader h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, magic, 4);
+    h.version = version;
+    h.byteOrder = byteOrder;
+    h.typeSizes[0] = sizeof(Vec2);
+    h.typeSizes[1] = sizeof(Rect);
+    h.typeSizes[2] = sizeof(House);
+    h.typeSizes[3] = sizeof(Road);
+    return h;
+}
+
+// Every section of a city file, in file order.
+template <typename Map, typename Hospitals, typename Parking, typename V>
+void visitCity(Map &m, Hospitals &hospitals, Parking &parking, V &v)
+{
+    v.value("CCFG", m.cfg);
+    v.value("MAPW", m.mapWidth);
+    v.value("MAPH", m.mapHeight);
+    v.array("ROAD", m.roads);
+    v.array("HOUS", m.houses);
+    v.array("HBID", m.houseById);
+    HousePicker::visitStorage(m.housePicker, v);
+    RoadGraph::visitStorage(m.graph, v);
+    RoadSnapper::visitStorage(m.snapper, v);
+    v.array("HOSP", hospitals);
+    v.array("PARK", parking);
+}
+
+// Collects the section table, then the data, into a file.
+struct Writer
+{
+    FILE *f = nullptr;
+    vector<CityFileSection> sections;
+    uint64_t end = 0; // layout pass: next free offset
+    bool writing = false;
+    uint64_t at = 0; // write pass: bytes written
+
+    template <typename T>
+    void array(const char *tag, const FlatArray<T> &a) { put(tag, a.data(), sizeof(T), a.size()); }
+    template <typename T>
+    void value(const char *tag, const T &x) { put(tag, &x, sizeof(T), 1); }
+
+    void put(const char *tag, const void *p, size_t elemSize, size_t count)
+    {
+        if (!writing)
+        {
+            CityFileSection s;
+            memcpy(s.tag, tag, 4);
+            s.elemSize = (uint32_t)elemSize;
+            s.offset = end = (end + sectionAlign - 1) / sectionAlign * sectionAlign;
+            s.count = count;
+            sections.push_back(s);
+            end += elemSize * count;
+            return;
+        }
+        static const char zeros[sectionAlign] = {};
+        size_t pad = (size_t)((sectionAlign - at % sectionAlign) % sectionAlign);
+        at += fwrite(zeros, 1, pad, f);
+        at += fwrite(p, elemSize, count, f) * elemSize;
+    }
+};
+
+// Points each array at its section of the mapping.
+struct Reader
+{
+    unsigned char *base = nullptr;
+    uint64_t size = 0;
+    const CityFileSection *sections = nullptr;
+    uint32_t count = 0, next = 0;
+    string error;
+
+    template <typename T>
+    void array(const char *tag, FlatArray<T> &a)
+    {
+        if (const CityFileSection *s = take(tag, sizeof(T)))
+            a.view((T *)(base + s->offset), (size_t)s->count);
+    }
+    template <typename T>
+    void value(const char *tag, T &x)
+    {
+        const CityFileSection *s = take(tag, sizeof(T));
+        if (s && s->count == 1)
+            memcpy(&x, base + s->offset, sizeof(T));
+        else if (s)
+            fail(tag, "holds more than one value");
+    }
+
+    const CityFileSection *take(const char *tag, size_t elemSize)
+    {
+        if (!error.empty())
+            return nullptr;
+        if (next >= count)
+        {
+            fail(tag, "is missing");
+            return nullptr;
+        }
+        const CityFileSection &s = sections[next++];
+        if (memcmp(s.tag, tag, 4))
+            fail(tag, "expected, found " + string(s.tag, 4));
+        else if (s.elemSize != elemSize)
+            fail(tag, "has elements of " + to_string(s.elemSize) + " bytes, expected " + to_string(elemSize));
+        else if (s.offset % sectionAlign || s.offset > size || s.count > (size - s.offset) / elemSize)
+            fail(tag, "lies outside the file");
+        return error.empty() ? &s : nullptr;
+    }
+
+    void fail(const char *tag, const string &what) { error = "section " + string(tag, 4) + " " + what; }
+};
+}
+
+// ----------------------------- Save / load --------------------------------
+
+// Writes `city` and `hospitals` next to `path` and renames the file into
+// place, so a run mapping the old file (or starting meanwhile) never sees a
+// half-written one. Returns false and describes the problem in `error`.
+inline bool saveCityFile(const string &path, const CityMap &city, const vector<HospitalSite> &hospitals, string &error)
+{
+    using namespace city_file_detail;
+    FlatArray<CityFileHospital> sites;
+    FlatArray<Vec2> parking;
+    for (auto &h : hospitals)
+    {
+        sites.push_back({h.location, h.onSceneDuration, (int)parking.size(), (int)h.parking.size()});
+        for (auto &p : h.parking)
+            parking.push_back(p);
+    }
+
+    Writer w;
+    visitCity(city, sites, parking, w); // lays out the sections
+    CityFileHeader header = expectedHeader();
+    header.sectionCount = (uint32_t)w.sections.size();
+    uint64_t tableEnd = sizeof header + w.sections.size() * sizeof(CityFileSection);
+    uint64_t shift = (tableEnd + sectionAlign - 1) / sectionAlign * sectionAlign;
+    for (auto &s : w.sections)
+        s.offset += shift;
+    header.fileSize = w.end + shift;
+
+    string tmp = path + ".tmp";
+    w.f = fopen(tmp.c_str(), "wb");
+    if (!w.f)
+    {
+        error = "cannot write " + tmp;
+        return false;
+    }
+    fwrite(&header, sizeof header, 1, w.f);
+    fwrite(w.sections.data(), sizeof(CityFileSection), w.sections.size(), w.f);
+    w.writing = true;
+    w.at = tableEnd;
+    visitCity(city, sites, parking, w);
+    bool ok = w.at == header.fileSize && !ferror(w.f);
+    ok = fclose(w.f) == 0 && ok;
+    if (!ok || !replaceFile(tmp, path))
+    {
+        remove(tmp.c_str());
+        error = "error writing " + path;
+        return false;
+    }
+    return true;
+}
+
+// Maps the city file at `path` into `city` and `hospitals`. The arrays of
+// `city` view the mapping, which stays open as long as any copy of the map
+// does. Beyond the header, section table and array sizes, the contents are
+// trusted, so only load files this program wrote.
+inline bool loadCityFile(const string &path, CityMap &city, vector<HospitalSite> &hospitals, string &error)
+{
+    using namespace city_file_detail;
+    auto file = make_shared<MappedFile>();
+    if (!file->open(path, error))
+        return false;
+
+    Reader r;
+    r.base = file->data();
+    r.size = file->size();
+    CityFileHeader expect = expectedHeader();
+    const CityFileHeader *h = (const CityFileHeader *)r.base;
+    if (r.size < sizeof *h || memcmp(h->magic, magic, 4))
+        error = path + " is not a city file";
+    else if (h->version != version)
+        error = path + ": unsupported city file version " + to_string(h->version);
+    else if (h->byteOrder != byteOrder || memcmp(h->typeSizes, expect.typeSizes, sizeof expect.typeSizes))
+        error = path + " was written by a build with a different byte order or struct layout";
+    else if (h->fileSize != r.size || h->sectionCount > (r.size - sizeof *h) / sizeof(CityFileSection))
+        error = path + " is truncated";
+    if (!error.empty())
+        return false;
+
+    CityMap m;
+    FlatArray<CityFileHospital> sites;
+    FlatArray<Vec2> parking;
+    r.sections = (const CityFileSection *)(r.base + sizeof *h);
+    r.count = h->sectionCount;
+    visitCity(m, sites, parking, r);
+    if (r.error.empty() && r.next != r.count)
+        r.error = to_string(r.count - r.next) + " unexpected sections";
+    if (r.error.empty() && !(m.graph.consistent() && m.snapper.consistent() && m.housePicker.consistent()))
+        r.error = "index arrays do not match";
+    for (size_t i = 0; r.error.empty() && i < sites.size(); ++i)
+        if (sites[i].parkingBegin < 0 || sites[i].parkingCount < 0 ||
+            (size_t)sites[i].parkingBegin + sites[i].parkingCount > parking.size())
+            r.error = "hospital parking out of range";
+    if (!r.error.empty())
+    {
+        error = path + ": " + r.error;
+        return false;
+    }
+
+    hospitals.clear();
+    for (auto &s : sites)
+        hospitals.push_back({s.location, s.onSceneDuration,
+                             vector<Vec2>(parking.begin() + s.parkingBegin, parking.begin() + s.parkingBegin + s.parkingCount)});
+    m.backing = file;
+    city = move(m);
+    return true;
+}
+
+// The hospitals of `sim` as sites, for saving alongside its map.
+inline vector<HospitalSite> hospitalSites(const Simulation &sim)
+{
+    vector<HospitalSite> out;
+    for (auto &h : sim.getHospitals())
+    {
+        HospitalSite s{h.getLocation(), h.onSceneDuration(), {}};
+        for (int i = 0; i < h.fleetSize(); ++i)
+            s.parking.push_back(h.getFleet().parking(i));
+        out.push_back(move(s));
+    }
+    return out;
+}
+
+inline void addHospitals(Simulation &sim, const vector<HospitalSite> &hospitals)
+{
+    for (auto &h : hospitals)
+        sim.addHospital(h.location, h.parking, h.onSceneDuration);
+}
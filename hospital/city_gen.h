@@ -0,0 +1,252 @@
+// Procedural cities for scale testing. Still axis-aligned, which RoadGraph
+// and its Manhattan heuristic rely on, but with uneven block sizes, wider
+// arterial roads at irregular intervals and local north-south roads that
+// stop short (T-junctions, dead-end blocks). Every house draws its shape and
+// colour from a hash of (seed, house index) instead of a shared generator,
+// so the house pass splits across threads and writes straight into the
+// preallocated house array, and the result does not depend on the thread
+// count.
+//
+// A city spec file is "key = value" lines, '#' starts a comment:
+//   layout = generated      # or grid
+//   seed = 7
+//   blocks = 1300           # or blocksX / blocksY
+//   jitter = 0.3
+//   arterialEvery = 8
+//   hospitals = 256
+//   units = 8
+// Keys are the CityConfig field names plus hospitals, units and threads.
+
+#pragma once
+
+#include "simulation.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+// A city plus what runs in it, as read from a spec file.
+struct CitySpec
+{
+    CityConfig cfg;
+    int hospitals = 1;
+    int units = 4;   // per hospital
+    int threads = 0; // generator threads, 0 = one per core
+};
+
+namespace city_gen_detail
+{
+inline uint64_t mix(uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Counter-based stream: the n-th draw for one house, in [0, 1).
+struct HouseRng
+{
+    uint64_t state;
+    float next()
+    {
+        state = mix(state);
+        return (state >> 40) * (1.0f / 16777216.0f);
+    }
+};
+
+// Centre lines and widths of the roads along one axis.
+inline void roadLines(int blocks, float start, const CityConfig &cfg, mt19937 &rng, vector<float> &at, vector<float> &width)
+{
+    uniform_real_distribution<float> spread(-1.0f, 1.0f);
+    float jitter = min(max(cfg.jitter, 0.0f), 0.45f); // keeps every block usable
+    int nextArterial = cfg.arterialEvery > 0 ? 1 + (int)(rng() % cfg.arterialEvery) : -1;
+    at.resize(blocks + 1);
+    width.resize(blocks + 1);
+    float pos = start;
+    for (int i = 0; i <= blocks; ++i)
+    {
+        at[i] = pos;
+        width[i] = cfg.roadW;
+        if (i == nextArterial && i < blocks)
+        {
+            width[i] = cfg.arterialW;
+            nextArterial += max(1, cfg.arterialEvery / 2 + (int)(rng() % cfg.arterialEvery));
+        }
+        pos += cfg.blockSize * (1.0f + jitter * spread(rng));
+    }
+}
+}
+
+inline CityMap generateCity(const CityConfig &cfg, int threads = 0)
+{
+    using namespace city_gen_detail;
+    CityMap m;
+    m.cfg = cfg;
+    mt19937 rng(cfg.seed ^ 0x5eedc17u);
+    vector<float> xs, xw, ys, yw;
+    roadLines(cfg.blocksX, cfg.startX, cfg, rng, xs, xw);
+    roadLines(cfg.blocksY, cfg.startY, cfg, rng, ys, yw);
+    m.mapWidth = xs.back() - xs.front() + cfg.roadW * 2;
+    m.mapHeight = ys.back() - ys.front() + cfg.roadW * 2;
+
+    // east-west roads run the full width, so every north-south road, cut
+    // short or not, meets at least two of them and the network stays connected
+    for (int y = 0; y <= cfg.blocksY; ++y)
+        m.roads.push_back({Rect{xs.front() - cfg.roadW / 2.0f, ys[y] - yw[y] / 2.0f, xs.back() - xs.front() + cfg.roadW, yw[y]}, true});
+    uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int x = 0; x <= cfg.blocksX; ++x)
+    {
+        int from = 0, to = cfg.blocksY;
+        bool local = x > 0 && x < cfg.blocksX && xw[x] == cfg.roadW;
+        if (local && cfg.blocksY > 1 && unit(rng) < cfg.deadEnds)
+        {
+            from = (int)(rng() % cfg.blocksY);
+            to = from + 1 + (int)(rng() % (cfg.blocksY - from));
+        }
+        float top = ys[from] - yw[from] / 2.0f, bottom = ys[to] + yw[to] / 2.0f;
+        m.roads.push_back({Rect{xs[x] - xw[x] / 2.0f, top, xw[x], bottom - top}, false});
+    }
+
+    // houses, row-major by lot as in buildGridCity, split by lot rows
+    const int lotCols = cfg.blocksX * cfg.lotsX, lotRows = cfg.blocksY * cfg.lotsY;
+    m.houses.resize((size_t)lotCols * lotRows);
+    const uint64_t seedKey = mix(cfg.seed);
+    auto fillRows = [&](int rowBegin, int rowEnd)
+    {
+        const float pad = 8.0f;
+        for (int py = rowBegin; py < rowEnd; ++py)
+        {
+            int by = py / cfg.lotsY, ly = py % cfg.lotsY;
+            float blockY = ys[by] + yw[by] / 2.0f;
+            float lotH = (ys[by + 1] - yw[by + 1] / 2.0f - blockY) / cfg.lotsY;
+            for (int px = 0; px < lotCols; ++px)
+            {
+                int bx = px / cfg.lotsX, lx = px % cfg.lotsX;
+                float blockX = xs[bx] + xw[bx] / 2.0f;
+                float lotW = (xs[bx + 1] - xw[bx + 1] / 2.0f - blockX) / cfg.lotsX;
+                size_t index = (size_t)py * lotCols + px;
+                HouseRng r{seedKey ^ (index * 0x9e3779b97f4a7c15ull)};
+                float x = blockX + lx * lotW + pad / 2.0f, y = blockY + ly * lotH + pad / 2.0f;
+                float w = lotW - pad, h = lotH - pad;
+                float vw = w * (0.75f + 0.2f * r.next()), vh = h * (0.55f + 0.3f * r.next());
+                House &house = m.houses[index];
+                house.body = {x + (w - vw) / 2.0f, y + (h - vh) / 2.0f + vh * 0.08f, vw, vh};
+                house.color = Rgba{(unsigned char)(60 + r.next() * 161), (unsigned char)(60 + r.next() * 161), (unsigned char)(60 + r.next() * 161), 255};
+                house.id = (int)index + 1;
+            }
+        }
+    };
+    if (threads <= 0)
+        threads = max(1u, thread::hardware_concurrency());
+    threads = min(threads, max(1, lotRows / 64));
+    vector<thread> workers;
+    for (int t = 1; t < threads; ++t)
+        workers.emplace_back(fillRows, (int)((long long)lotRows * t / threads), (int)((long long)lotRows * (t + 1) / threads));
+    fillRows(0, lotRows / threads);
+    for (auto &w : workers)
+        w.join();
+
+    m.graph.build(m.roads);
+    m.snapper.build(m.graph.positions());
+    m.indexHouses();
+    return m;
+}
+
+// The city a config describes, whichever layout it uses.
+inline CityMap buildCity(const CityConfig &cfg, int threads = 0)
+{
+    return cfg.layout == CityLayout::GENERATED ? generateCity(cfg, threads) : buildGridCity(cfg);
+}
+
+// Reads a city spec file over the defaults already in `spec`. Returns false
+// and describes the first problem in `error`.
+inline bool loadCitySpec(const string &path, CitySpec &spec, string &error)
+{
+    FILE *f = fopen(path.c_str(), "r");
+    if (!f)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+    CityConfig &c = spec.cfg;
+    char line[256];
+    int lineNo = 0;
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), f))
+    {
+        lineNo++;
+        if (char *hash = strchr(line, '#'))
+            *hash = '\0';
+        char key[64], value[64];
+        int n = sscanf(line, " %63[A-Za-z] = %63s", key, value);
+        if (n <= 0)
+            continue; // blank or comment
+        if (n != 2)
+        {
+            error = path + ":" + to_string(lineNo) + ": expected key = value";
+            ok = false;
+            break;
+        }
+        string k = key;
+        double v = atof(value);
+        if (k == "layout")
+        {
+            if (!strcmp(value, "grid"))
+                c.layout = CityLayout::GRID;
+            else if (!strcmp(value, "generated"))
+                c.layout = CityLayout::GENERATED;
+            else
+            {
+                error = path + ":" + to_string(lineNo) + ": layout is grid or generated";
+                ok = false;
+            }
+        }
+        else if (k == "seed")
+            c.seed = (unsigned)strtoul(value, nullptr, 10);
+        else if (k == "blocks")
+            c.blocksX = c.blocksY = (int)v;
+        else if (k == "blocksX")
+            c.blocksX = (int)v;
+        else if (k == "blocksY")
+            c.blocksY = (int)v;
+        else if (k == "blockSize")
+            c.blockSize = (float)v;
+        else if (k == "roadW")
+            c.roadW = (float)v;
+        else if (k == "sidewalk")
+            c.sidewalk = (float)v;
+        else if (k == "lotsX")
+            c.lotsX = (int)v;
+        else if (k == "lotsY")
+            c.lotsY = (int)v;
+        else if (k == "jitter")
+            c.jitter = (float)v;
+        else if (k == "arterialEvery")
+            c.arterialEvery = (int)v;
+        else if (k == "arterialW")
+            c.arterialW = (float)v;
+        else if (k == "deadEnds")
+            c.deadEnds = (float)v;
+        else if (k == "hospitals")
+            spec.hospitals = (int)v;
+        else if (k == "units")
+            spec.units = (int)v;
+        else if (k == "threads")
+            spec.threads = (int)v;
+        else
+        {
+            error = path + ":" + to_string(lineNo) + ": unknown key " + k;
+            ok = false;
+        }
+    }
+    fclose(f);
+    if (ok && (c.blocksX < 1 || c.blocksY < 1 || c.lotsX < 1 || c.lotsY < 1 || spec.hospitals < 1 || spec.units < 1))
+    {
+        error = path + ": blocks, lots, hospitals and units must be at least 1";
+        ok = false;
+    }
+    return ok;
+}
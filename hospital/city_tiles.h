@@ -0,0 +1,224 @@
+// Static city layer for the GUI. Roads, houses and their number labels never
+// change while the simulation runs, so they are baked into RenderTexture2D
+// tiles once and each frame only blits the tiles that intersect the view: a
+// handful of textured quads instead of one draw call per lane dash, window
+// and label of the whole city. Tiles are baked the first time they come into
+// view and the least recently seen ones are released beyond `maxResident`, so
+// a very large city never holds more than that many textures. Anything that
+// changes from frame to frame (emergency pulses, hover, ambulances) is drawn
+// on top by the caller.
+
+#pragma once
+
+#include "raylib.h"
+#include "simulation.h"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+class CityTiles
+{
+public:
+    static const int tileSize = 512;   // pixels per tile side
+    static const int maxResident = 96; // baked tiles kept, 1 MB of RGBA each
+
+    CityTiles() = default;
+    ~CityTiles() { release(); }
+
+    CityTiles(const CityTiles &) = delete;
+    CityTiles &operator=(const CityTiles &) = delete;
+
+    // Bins the map into tiles; call again whenever the map changes. Nothing is
+    // baked yet, so this is cheap, but it needs the window to be open.
+    void rebuild(const CityMap &city)
+    {
+        release();
+        map = &city;
+        const CityConfig &cfg = city.cfg;
+        // the grass backdrop, 300 px past the grid on every side
+        extent = Rect{cfg.startX - 300, cfg.startY - 300, city.mapWidth + 600, city.mapHeight + 600};
+        cols = max(1, (int)ceilf(extent.width / tileSize));
+        rows = max(1, (int)ceilf(extent.height / tileSize));
+        tiles.assign((size_t)cols * rows, Tile());
+
+        for (size_t i = 0; i < city.roads.size(); ++i)
+        {
+            const Road &r = city.roads[i];
+            float sw = cfg.sidewalk;
+            Rect b = r.horizontal ? Rect{r.rect.x, r.rect.y - sw, r.rect.width, r.rect.height + 2 * sw}
+                                  : Rect{r.rect.x - sw, r.rect.y, r.rect.width + 2 * sw, r.rect.height};
+            forTilesIn(b, [&](Tile &t) { t.roads.push_back((int)i); });
+        }
+        for (size_t i = 0; i < city.houses.size(); ++i)
+        {
+            const House &h = city.houses[i];
+            const Rect &hb = h.body;
+            // roof above, number label below and possibly wider than the house
+            float labelW = (float)MeasureText(to_string(h.id).c_str(), 10);
+            float left = min(hb.x - 2, hb.x + hb.width / 2 - labelW / 2);
+            float right = max(hb.x + hb.width + 2, hb.x + hb.width / 2 + labelW / 2);
+            Rect b{left, hb.y - hb.height * 0.35f, right - left, hb.height * 1.35f + 14};
+            forTilesIn(b, [&](Tile &t) { t.houses.push_back((int)i); });
+        }
+    }
+
+    // Draws the tiles under the view, baking the ones seen for the first time.
+    // Must be called between BeginDrawing and EndDrawing.
+    void draw(float offsetX, float offsetY, int screenW, int screenH)
+    {
+        if (!map)
+            return;
+        frame++;
+        viewRange(offsetX, offsetY, screenW, screenH, 0.0f);
+        for (int ty = y0; ty <= y1; ++ty)
+            for (int tx = x0; tx <= x1; ++tx)
+            {
+                int idx = ty * cols + tx;
+                Tile &t = tiles[idx];
+                if (!t.baked)
+                    bake(idx);
+                t.lastUsed = frame;
+                Vector2 pos = {extent.x + tx * tileSize + offsetX, extent.y + ty * tileSize + offsetY};
+                // render textures come out upside down, hence the negative height
+                DrawTextureRec(t.target.texture, Rectangle{0, 0, (float)tileSize, -(float)tileSize}, pos, WHITE);
+            }
+        evict();
+    }
+
+    int residentCount() const { return (int)resident.size(); }
+
+    // Frees every baked texture; call before CloseWindow.
+    void release()
+    {
+        for (int idx : resident)
+        {
+            UnloadRenderTexture(tiles[idx].target);
+            tiles[idx].baked = false;
+        }
+        resident.clear();
+    }
+
+private:
+    struct Tile
+    {
+        vector<int> roads, houses; // everything that paints into the tile, in draw order
+        RenderTexture2D target{};
+        bool baked = false;
+        long long lastUsed = 0;
+    };
+
+    const CityMap *map = nullptr;
+    Rect extent{};
+    int cols = 0, rows = 0;
+    vector<Tile> tiles;
+    vector<int> resident; // baked tile indices
+    long long frame = 0;
+    int x0 = 0, y0 = 0, x1 = -1, y1 = -1; // last view range, inclusive
+
+    int tileAt(float x, float y) const
+    {
+        int tx = min(cols - 1, max(0, (int)floorf((x - extent.x) / tileSize)));
+        int ty = min(rows - 1, max(0, (int)floorf((y - extent.y) / tileSize)));
+        return ty * cols + tx;
+    }
+
+    template <typename F>
+    void forTilesIn(const Rect &b, F &&f)
+    {
+        int a = tileAt(b.x, b.y), c = tileAt(b.x + b.width, b.y + b.height);
+        for (int ty = a / cols; ty <= c / cols; ++ty)
+            for (int tx = a % cols; tx <= c % cols; ++tx)
+                f(tiles[ty * cols + tx]);
+    }
+
+    void viewRange(float offsetX, float offsetY, int screenW, int screenH, float margin)
+    {
+        float left = -offsetX - margin, top = -offsetY - margin;
+        float right = left + screenW + 2 * margin, bottom = top + screenH + 2 * margin;
+        x0 = max(0, (int)floorf((left - extent.x) / tileSize));
+        y0 = max(0, (int)floorf((top - extent.y) / tileSize));
+        x1 = min(cols - 1, (int)floorf((right - extent.x) / tileSize));
+        y1 = min(rows - 1, (int)floorf((bottom - extent.y) / tileSize));
+    }
+
+    void bake(int idx)
+    {
+        Tile &t = tiles[idx];
+        const CityMap &city = *map;
+        float ox = -(extent.x + (idx % cols) * tileSize), oy = -(extent.y + (idx / cols) * tileSize);
+        t.target = LoadRenderTexture(tileSize, tileSize);
+        t.baked = true;
+        resident.push_back(idx);
+
+        BeginTextureMode(t.target);
+        // the window clears to the same colour outside the backdrop
+        ClearBackground(Color{180, 210, 180, 255});
+        DrawRectangleRec(Rectangle{extent.x + ox, extent.y + oy, extent.width, extent.height}, Color{200, 230, 190, 255});
+
+        const float sidewalk = city.cfg.sidewalk;
+        for (int i : t.roads)
+        {
+            const Road &r = city.roads[i];
+            Rectangle rect = {r.rect.x + ox, r.rect.y + oy, r.rect.width, r.rect.height};
+            if (r.horizontal)
+            {
+                DrawRectangleRec(Rectangle{rect.x, rect.y - sidewalk, rect.width, sidewalk}, Color{200, 200, 200, 255});
+                DrawRectangleRec(Rectangle{rect.x, rect.y + rect.height, rect.width, sidewalk}, Color{200, 200, 200, 255});
+            }
+            else
+            {
+                DrawRectangleRec(Rectangle{rect.x - sidewalk, rect.y, sidewalk, rect.height}, Color{200, 200, 200, 255});
+                DrawRectangleRec(Rectangle{rect.x + rect.width, rect.y, sidewalk, rect.height}, Color{200, 200, 200, 255});
+            }
+            DrawRectangleRec(rect, Color{80, 80, 80, 255});
+            // lane dashes pre-blended onto the asphalt: a translucent colour
+            // would leave translucent texels in the tile
+            const Color dashColor = {205, 198, 127, 255};
+            float dash = 18.0f;
+            if (r.horizontal)
+                for (float x = rect.x + 6; x < rect.x + rect.width - 6; x += dash * 2)
+                    DrawRectangle((int)x, (int)(rect.y + rect.height / 2 - 2), (int)dash, 4, dashColor);
+            else
+                for (float y = rect.y + 6; y < rect.y + rect.height - 6; y += dash * 2)
+                    DrawRectangle((int)(rect.x + rect.width / 2 - 2), (int)y, 4, (int)dash, dashColor);
+        }
+
+        for (int i : t.houses)
+        {
+            const House &h = city.houses[i];
+            Rectangle hb = {h.body.x + ox, h.body.y + oy, h.body.width, h.body.height};
+            DrawTriangle(Vector2{hb.x + hb.width * 0.5f, hb.y - hb.height * 0.35f}, Vector2{hb.x - 2, hb.y + 3}, Vector2{hb.x + hb.width + 2, hb.y + 3}, Color{120, 80, 60, 255});
+            DrawRectangleRec(hb, Color{h.color.r, h.color.g, h.color.b, h.color.a});
+            DrawRectangle((int)(hb.x + hb.width * 0.06f), (int)(hb.y + hb.height * 0.52f), (int)(hb.width * 0.16f), (int)(hb.height * 0.42f), Color{90, 50, 30, 255});
+            DrawRectangle((int)(hb.x + hb.width * 0.43f), (int)(hb.y + hb.height * 0.26f), (int)(hb.width * 0.2f), (int)(hb.height * 0.18f), Color{200, 230, 255, 255});
+            DrawRectangleLinesEx(Rectangle{hb.x + hb.width * 0.43f, hb.y + hb.height * 0.26f, hb.width * 0.2f, hb.height * 0.18f}, 1, BLACK);
+
+            string idStr = to_string(h.id);
+            DrawText(idStr.c_str(), (int)(hb.x + hb.width / 2 - MeasureText(idStr.c_str(), 10) / 2), (int)(hb.y + hb.height + 2), 10, DARKGRAY);
+        }
+        EndTextureMode();
+    }
+
+    // Release the least recently seen tiles beyond the budget; tiles drawn
+    // this frame are never released.
+    void evict()
+    {
+        while ((int)resident.size() > maxResident)
+        {
+            size_t oldest = 0;
+            for (size_t k = 1; k < resident.size(); ++k)
+                if (tiles[resident[k]].lastUsed < tiles[resident[oldest]].lastUsed)
+                    oldest = k;
+            Tile &t = tiles[resident[oldest]];
+            if (t.lastUsed == frame)
+                break;
+            UnloadRenderTexture(t.target);
+            t.baked = false;
+            resident[oldest] = resident.back();
+            resident.pop_back();
+        }
+    }
+};
@@ -0,0 +1,302 @@
+// All-pairs road distances between intersections, for cities small enough
+// that an n x n table fits (up to maxNodes intersections: 10k take 200 MB,
+// 50k take 5 GB). Each entry is 16 bits:
+//   bits 15..2  distance from the row's source, in units of that row's scale
+//               (its longest distance / 16382), so any entry is within half
+//               a unit, a fraction of a pixel on grid cities
+//   bits 1..0   which of the source's arcs starts a shortest path (road
+//               intersections have at most four)
+// A distance lookup is one read; a route walks the next hops.
+//
+// Rows are independent Dijkstra runs, built in parallel. save() writes the
+// table to a cache file and load() maps one back, checked against a hash of
+// the road graph so a cache of another city or an edited one is rejected.
+// The table describes the graph as it was built: closing arcs afterwards
+// (RoadGraph::setArcClosed) is not reflected.
+
+#pragma once
+
+#include "mapped_file.h"
+#include "road_graph.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+struct DistanceTableHeader
+{
+    char magic[4];      // "EMDT"
+    uint32_t version;
+    uint32_t byteOrder; // 0x01020304 as written
+    uint32_t nodes;
+    uint64_t graphHash; // DistanceTable::graphHash of the graph it was built from
+    uint64_t fileSize;
+};
+
+class DistanceTable
+{
+public:
+    static const int maxNodes = 50000;
+    static const uint16_t unreachable = 0x3FFF; // distance field of a pair with no road path
+
+    int nodeCount() const { return n; }
+    size_t bytes() const { return codes.size() * sizeof(uint16_t) + rowScale.size() * sizeof(float); }
+    bool mapped() const { return backing != nullptr; }
+
+    // Road distance from intersection s to t, -1 when t cannot be reached
+    // (as RoadGraph::shortestPath).
+    float distance(int s, int t) const
+    {
+        uint16_t c = codes[(size_t)s * n + t];
+        return (c >> 2) == unreachable ? -1.0f : (c >> 2) * rowScale[s];
+    }
+
+    // Neighbour of s on a shortest path to t; -1 for t == s or unreachable.
+    int nextHop(const RoadGraph &graph, int s, int t) const
+    {
+        uint16_t c = codes[(size_t)s * n + t];
+        if (s == t || (c >> 2) == unreachable)
+            return -1;
+        return graph.arcTarget(graph.arcBegin(s) + (c & 3));
+    }
+
+    // Intersections s..t of a shortest path, by following next hops.
+    // Returns the distance, or -1 (outNodes empty) when t is unreachable.
+    float path(const RoadGraph &graph, int s, int t, vector<int> &outNodes) const
+    {
+        outNodes.clear();
+        float d = distance(s, t);
+        if (d < 0.0f)
+            return d;
+        outNodes.push_back(s);
+        for (int u = s; u != t && (int)outNodes.size() <= n;)
+            outNodes.push_back(u = nextHop(graph, u, t));
+        return d;
+    }
+
+    // Runs Dijkstra from every intersection on `threads` threads (0 = one per
+    // core). The result does not depend on the thread count.
+    bool build(const RoadGraph &graph, int threads, string &error)
+    {
+        int nodes = graph.nodeCount();
+        if (nodes > maxNodes)
+        {
+            error = to_string(nodes) + " intersections, the distance table takes at most " + to_string(maxNodes);
+            return false;
+        }
+        for (int u = 0; u < nodes; ++u)
+            if (graph.arcEnd(u) - graph.arcBegin(u) > 4)
+            {
+                error = "intersection " + to_string(u) + " has more than four roads";
+                return false;
+            }
+        backing.reset();
+        n = nodes;
+        hash = graphHash(graph);
+        rowScale.assign(n, 0.0f);
+        codes.assign((size_t)n * n, 0);
+
+        atomic<int> nextRow{0};
+        auto work = [&]()
+        {
+            Search sc;
+            for (int s = nextRow.fetch_add(1); s < n; s = nextRow.fetch_add(1))
+                fillRow(graph, s, sc);
+        };
+        if (threads <= 0)
+            threads = max(1u, thread::hardware_concurrency());
+        threads = min(threads, max(1, n / 64));
+        vector<thread> workers;
+        for (int t = 1; t < threads; ++t)
+            workers.emplace_back(work);
+        work();
+        for (auto &w : workers)
+            w.join();
+        return true;
+    }
+
+    // Writes the table next to `path` and renames it into place, so a run
+    // starting meanwhile never maps half a file.
+    bool save(const string &path, string &error) const
+    {
+        DistanceTableHeader h = header();
+        string tmp = path + ".tmp";
+        FILE *f = fopen(tmp.c_str(), "wb");
+        if (!f)
+        {
+            error = "cannot write " + tmp;
+            return false;
+        }
+        static const char zeros[align] = {};
+        bool ok = fwrite(&h, sizeof h, 1, f) == 1;
+        ok = ok && fwrite(zeros, 1, scaleOffset() - sizeof h, f) == scaleOffset() - sizeof h;
+        ok = ok && fwrite(rowScale.data(), sizeof(float), rowScale.size(), f) == rowScale.size();
+        size_t pad = codeOffset() - scaleOffset() - rowScale.size() * sizeof(float);
+        ok = ok && fwrite(zeros, 1, pad, f) == pad;
+        ok = ok && fwrite(codes.data(), sizeof(uint16_t), codes.size(), f) == codes.size();
+        ok = fclose(f) == 0 && ok;
+        if (!ok || !replaceFile(tmp, path))
+        {
+            remove(tmp.c_str());
+            error = "error writing " + path;
+            return false;
+        }
+        return true;
+    }
+
+    // Maps the table cached at `path`, if it was built from `graph`.
+    bool load(const string &path, const RoadGraph &graph, string &error)
+    {
+        auto file = make_shared<MappedFile>();
+        if (!file->open(path, error))
+            return false;
+        const DistanceTableHeader *h = (const DistanceTableHeader *)file->data();
+        DistanceTable expect;
+        expect.n = graph.nodeCount();
+        expect.hash = graphHash(graph);
+        DistanceTableHeader want = expect.header();
+        if (file->size() < sizeof *h || memcmp(h->magic, want.magic, 4))
+            error = path + " is not a distance table";
+        else if (h->version != want.version || h->byteOrder != want.byteOrder)
+            error = path + " was written by a different version or byte order";
+        else if (h->nodes != want.nodes || h->graphHash != want.graphHash)
+            error = path + " was built for a different road graph";
+        else if (h->fileSize != want.fileSize || file->size() != want.fileSize)
+            error = path + " is truncated";
+        if (!error.empty())
+            return false;
+        n = expect.n;
+        hash = expect.hash;
+        rowScale.view((float *)(file->data() + scaleOffset()), n);
+        codes.view((uint16_t *)(file->data() + codeOffset()), (size_t)n * n);
+        backing = file;
+        return true;
+    }
+
+    // FNV-1a over the intersections and arcs.
+    static uint64_t graphHash(const RoadGraph &graph)
+    {
+        uint64_t h = 1469598103934665603ull;
+        auto mix = [&h](const void *p, size_t len)
+        {
+            const unsigned char *b = (const unsigned char *)p;
+            for (size_t i = 0; i < len; ++i)
+                h = (h ^ b[i]) * 1099511628211ull;
+        };
+        int nodes = graph.nodeCount();
+        mix(&nodes, sizeof nodes);
+        for (int u = 0; u < nodes; ++u)
+        {
+            Vec2 p = graph.position(u);
+            mix(&p, sizeof p);
+            for (int a = graph.arcBegin(u); a < graph.arcEnd(u); ++a)
+            {
+                int v = graph.arcTarget(a);
+                float c = graph.arcCost(a);
+                mix(&v, sizeof v);
+                mix(&c, sizeof c);
+            }
+        }
+        return h;
+    }
+
+private:
+    static const uint32_t version = 1;
+    static const size_t align = 64;
+
+    int n = 0;
+    uint64_t hash = 0;
+    FlatArray<float> rowScale; // world units per distance step, by source
+    FlatArray<uint16_t> codes; // n x n, row = source
+    shared_ptr<const MappedFile> backing;
+
+    // Per-thread Dijkstra state, reused across rows.
+    struct Search
+    {
+        vector<float> dist;
+        vector<unsigned char> first; // arc slot at the source leading here
+        vector<pair<float, int>> open;
+    };
+
+    void fillRow(const RoadGraph &graph, int s, Search &sc)
+    {
+        const float inf = numeric_limits<float>::infinity();
+        sc.dist.assign(n, inf);
+        sc.first.assign(n, 0);
+        sc.open.clear();
+        sc.dist[s] = 0.0f;
+        sc.open.push_back({0.0f, s});
+        auto later = [](const pair<float, int> &a, const pair<float, int> &b) { return a.first > b.first; };
+        float longest = 0.0f;
+        while (!sc.open.empty())
+        {
+            pop_heap(sc.open.begin(), sc.open.end(), later);
+            auto [d, u] = sc.open.back();
+            sc.open.pop_back();
+            if (d > sc.dist[u])
+                continue;
+            longest = d;
+            for (int a = graph.arcBegin(u); a < graph.arcEnd(u); ++a)
+            {
+                float c = graph.arcCost(a);
+                if (c == RoadGraph::CLOSED)
+                    continue;
+                int v = graph.arcTarget(a);
+                if (d + c < sc.dist[v])
+                {
+                    sc.dist[v] = d + c;
+                    sc.first[v] = u == s ? (unsigned char)(a - graph.arcBegin(s)) : sc.first[u];
+                    sc.open.push_back({d + c, v});
+                    push_heap(sc.open.begin(), sc.open.end(), later);
+                }
+            }
+        }
+        float scale = longest > 0.0f ? longest / (unreachable - 1) : 1.0f;
+        rowScale[s] = scale;
+        uint16_t *row = codes.data() + (size_t)s * n;
+        for (int t = 0; t < n; ++t)
+        {
+            uint16_t q = sc.dist[t] == inf ? unreachable : (uint16_t)min<long>(lroundf(sc.dist[t] / scale), unreachable - 1);
+            row[t] = (uint16_t)(q << 2 | sc.first[t]);
+        }
+    }
+
+    size_t scaleOffset() const { return align; }
+    size_t codeOffset() const { return (scaleOffset() + (size_t)n * sizeof(float) + align - 1) / align * align; }
+
+    DistanceTableHeader header() const
+    {
+        DistanceTableHeader h;
+        memset(&h, 0, sizeof h);
+        memcpy(h.magic, "EMDT", 4);
+        h.version = version;
+        h.byteOrder = 0x01020304;
+        h.nodes = (uint32_t)n;
+        h.graphHash = hash;
+        h.fileSize = codeOffset() + (size_t)n * n * sizeof(uint16_t);
+        return h;
+    }
+};
+
+// The table of `graph`: mapped from the cache at `path` when that holds it,
+// otherwise built and written there (an empty path only builds). Null, with
+// `error` set, when the table cannot be built or the cache not written.
+inline shared_ptr<DistanceTable> openDistanceTable(const string &path, const RoadGraph &graph, int threads, string &error)
+{
+    auto table = make_shared<DistanceTable>();
+    string ignored;
+    if (!path.empty() && table->load(path, graph, ignored))
+        return table;
+    if (!table->build(graph, threads, error) || (!path.empty() && !table->save(path, error)))
+        return nullptr;
+    return table;
+}
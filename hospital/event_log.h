@@ -0,0 +1,413 @@
+// Append-only binary log of everything the dispatcher decided: the world it
+// started from, every emergency taken in, where it was routed, which unit
+// was assigned, every unit status change, plus periodic state hashes.
+// Together with the fixed timestep this is enough to rerun a session
+// exactly (see replay.h).
+//
+// File layout: "EMLG", u32 version, then records of
+//   u8 tag, u16 payload size, payload
+// with little-endian fields. Records after setup are stamped by a TICK
+// record whenever the simulation tick changed since the previous record.
+
+#pragma once
+
+#include "sim_types.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+class EventLog
+{
+public:
+    enum Tag : unsigned char
+    {
+        CONFIG = 1, // city config, fixed step, dispatch mode, distance table
+        HOSPITAL,   // location, on-scene time, parking bays
+        TICK,       // i64 tick of the records that follow
+        INTAKE,     // requested hospital (-1 = routed) + emergency
+        ROUTED,     // hospital, hospital-local emergency id
+        ASSIGN,     // hospital, emergency id, ambulance id
+        STATUS,     // hospital, ambulance id, new status
+        LEND,       // from hospital, its id, to hospital, new id
+        CHECKPOINT, // u64 state hash
+        END         // u64 state hash when the session closed
+    };
+
+    static const uint32_t magic = 0x474C4D45; // "EMLG"
+    static const uint32_t version = 7;
+
+    // Memory-only log; everything written stays in bytes().
+    EventLog() { putHeader(); }
+
+    // Also written to `path` (truncated), flushed in 64 KiB chunks.
+    explicit EventLog(const string &path)
+    {
+        toFile = true;
+        file = fopen(path.c_str(), "wb");
+        putHeader();
+    }
+
+    ~EventLog()
+    {
+        flush();
+        if (file)
+            fclose(file);
+    }
+
+    EventLog(const EventLog &) = delete;
+    EventLog &operator=(const EventLog &) = delete;
+
+    bool ok() const { return file != nullptr || !toFile; }
+    const vector<unsigned char> &bytes() const { return buf; }
+
+    void setTick(long long t) { tick = t; }
+
+    void config(const CityConfig &c, float fixedStep, unsigned char dispatchMode, bool distanceTable)
+    {
+        begin(CONFIG, false);
+        putI(c.blocksX), putI(c.blocksY), putF(c.blockSize), putF(c.roadW), putF(c.sidewalk);
+        putF(c.startX), putF(c.startY), putI(c.lotsX), putI(c.lotsY), putU(c.seed);
+        put8((unsigned char)c.layout), putF(c.jitter), putI(c.arterialEvery), putF(c.arterialW), putF(c.deadEnds);
+        putF(fixedStep);
+        put8(dispatchMode);
+        put8(distanceTable);
+        end();
+    }
+
+    void hospital(Vec2 loc, float onSceneDuration, const vector<Vec2> &parking)
+    {
+        begin(HOSPITAL, false);
+        putV(loc), putF(onSceneDuration), putU((uint32_t)parking.size());
+        for (auto &p : parking)
+            putV(p);
+        end();
+    }
+
+    void intake(int requestedHospital, const Emergency &e)
+    {
+        begin(INTAKE);
+        putI(requestedHospital), putI(e.priority), putV(e.location);
+        putI(e.patient.houseNumber), putI(e.patient.age);
+        putS(e.patient.name), putS(e.patient.severity), putS(e.patient.desc);
+        end();
+    }
+
+    void routed(int hospital, int id)
+    {
+        begin(ROUTED);
+        putI(hospital), putI(id);
+        end();
+    }
+
+    void assign(int hospital, int emergencyId, int ambulanceId)
+    {
+        begin(ASSIGN);
+        putI(hospital), putI(emergencyId), putI(ambulanceId);
+        end();
+    }
+
+    void status(int hospital, int ambulanceId, Ambulance::Status s)
+    {
+        begin(STATUS);
+        putI(hospital), putI(ambulanceId), put8((unsigned char)s);
+        end();
+    }
+
+    void lend(int from, int fromId, int to, int toId)
+    {
+        begin(LEND);
+        putI(from), putI(fromId), putI(to), putI(toId);
+        end();
+    }
+
+    void checkpoint(uint64_t hash, bool final = false)
+    {
+        begin(final ? END : CHECKPOINT);
+        put64(hash);
+        end();
+        if (final)
+            flush();
+    }
+
+    void flush()
+    {
+        if (!file || buf.empty())
+            return;
+        fwrite(buf.data(), 1, buf.size(), file);
+        fflush(file);
+        buf.clear();
+    }
+
+private:
+    static const size_t flushBytes = 64 * 1024;
+    static const size_t maxString = 1024;
+
+    FILE *file = nullptr;
+    bool toFile = false;
+    vector<unsigned char> buf;
+    size_t recordStart = 0;
+    long long tick = 0, writtenTick = -1;
+
+    void putHeader() { putU(magic), putU(version); }
+
+    void begin(Tag tag, bool stamped = true)
+    {
+        if (stamped && tick != writtenTick)
+        {
+            writtenTick = tick;
+            put8(TICK), put16(8), put64((uint64_t)tick);
+        }
+        recordStart = buf.size();
+        put8(tag), put16(0);
+    }
+
+    void end()
+    {
+        size_t size = buf.size() - recordStart - 3;
+        buf[recordStart + 1] = (unsigned char)(size & 0xFF);
+        buf[recordStart + 2] = (unsigned char)(size >> 8);
+        if (file && buf.size() >= flushBytes)
+            flush();
+    }
+
+    void put8(unsigned char v) { buf.push_back(v); }
+    void put16(uint16_t v) { put8(v & 0xFF), put8(v >> 8); }
+    void putU(uint32_t v)
+    {
+        for (int i = 0; i < 4; ++i)
+            put8((v >> (8 * i)) & 0xFF);
+    }
+    void put64(uint64_t v)
+    {
+        for (int i = 0; i < 8; ++i)
+            put8((v >> (8 * i)) & 0xFF);
+    }
+    void putI(int v) { putU((uint32_t)v); }
+    void putF(float v)
+    {
+        uint32_t u;
+        memcpy(&u, &v, 4);
+        putU(u);
+    }
+    void putV(Vec2 v) { putF(v.x), putF(v.y); }
+    void putS(const string &s)
+    {
+        size_t n = min(s.size(), maxString);
+        put16((uint16_t)n);
+        buf.insert(buf.end(), s.begin(), s.begin() + n);
+    }
+};
+
+// One decoded record; only the fields of its tag are meaningful.
+struct LogRecord
+{
+    EventLog::Tag tag = EventLog::CONFIG;
+    long long tick = 0;
+    size_t offset = 0, size = 0; // raw record span in the log, header included
+
+    CityConfig city;
+    float fixedStep = 0.0f;
+    unsigned char dispatchMode = 0;
+    bool distanceTable = false; // dispatch ranked units through a DistanceTable
+    Vec2 location;
+    float onSceneDuration = 0.0f;
+    vector<Vec2> parking;
+    int hospital = -1, id = -1, ambulanceId = -1; // ROUTED/ASSIGN/STATUS, LEND "from"
+    int toHospital = -1, toId = -1;               // LEND
+    Emergency emergency;                          // INTAKE, requested hospital in assignedHospital
+    Ambulance::Status status = Ambulance::Status::IDLE;
+    uint64_t hash = 0;
+};
+
+class EventLogReader
+{
+public:
+    explicit EventLogReader(const vector<unsigned char> &logBytes) : data(logBytes)
+    {
+        if (data.size() < 8 || get32At(0) != EventLog::magic)
+            error = "not an event log";
+        else if (get32At(4) != EventLog::version)
+            error = "unsupported event log version " + to_string(get32At(4));
+        pos = 8;
+    }
+
+    static bool loadFile(const string &path, vector<unsigned char> &out)
+    {
+        FILE *f = fopen(path.c_str(), "rb");
+        if (!f)
+            return false;
+        out.clear();
+        unsigned char chunk[1 << 16];
+        size_t n;
+        while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0)
+            out.insert(out.end(), chunk, chunk + n);
+        fclose(f);
+        return true;
+    }
+
+    bool ok() const { return error.empty(); }
+    const string &lastError() const { return error; }
+    bool truncated() const { return cutOff; } // the log ends inside a record
+
+    // Next non-TICK record, false at the end of the log or on a damaged one.
+    bool next(LogRecord &r)
+    {
+        while (ok() && pos + 3 <= data.size())
+        {
+            size_t start = pos;
+            unsigned char tag = data[pos];
+            size_t size = data[pos + 1] | (data[pos + 2] << 8);
+            if (pos + 3 + size > data.size())
+            {
+                error = "truncated record at offset " + to_string(pos);
+                cutOff = true;
+                return false;
+            }
+            cur = pos + 3;
+            pos = cur + size;
+            short_ = false;
+            if (tag == EventLog::TICK)
+            {
+                tick = (long long)get64();
+                continue;
+            }
+            r.tag = (EventLog::Tag)tag;
+            r.tick = tick;
+            r.offset = start;
+            r.size = pos - start;
+            decode(r);
+            if (short_)
+            {
+                error = "malformed record at offset " + to_string(start);
+                return false;
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    const vector<unsigned char> &data;
+    size_t pos = 0, cur = 0;
+    long long tick = 0;
+    string error;
+    bool short_ = false; // a field ran past the end of its record
+    bool cutOff = false;
+
+    bool need(size_t n)
+    {
+        if (cur + n > pos)
+            short_ = true;
+        return !short_;
+    }
+
+    uint32_t get32At(size_t at) const
+    {
+        return data[at] | (data[at + 1] << 8) | (data[at + 2] << 16) | ((uint32_t)data[at + 3] << 24);
+    }
+    unsigned char get8() { return need(1) ? data[cur++] : 0; }
+    uint16_t get16()
+    {
+        if (!need(2))
+            return 0;
+        uint16_t v = data[cur] | (data[cur + 1] << 8);
+        cur += 2;
+        return v;
+    }
+    uint32_t getU()
+    {
+        if (!need(4))
+            return 0;
+        uint32_t v = get32At(cur);
+        cur += 4;
+        return v;
+    }
+    uint64_t get64()
+    {
+        uint64_t lo = getU();
+        return lo | ((uint64_t)getU() << 32);
+    }
+    int getI() { return (int)getU(); }
+    float getF()
+    {
+        uint32_t u = getU();
+        float v;
+        memcpy(&v, &u, 4);
+        return v;
+    }
+    Vec2 getV()
+    {
+        float x = getF();
+        return Vec2{x, getF()};
+    }
+    string getS()
+    {
+        size_t n = get16();
+        if (!need(n))
+            return string();
+        string s(data.begin() + cur, data.begin() + cur + n);
+        cur += n;
+        return s;
+    }
+
+    void decode(LogRecord &r)
+    {
+        switch (r.tag)
+        {
+        case EventLog::CONFIG:
+            r.city.blocksX = getI(), r.city.blocksY = getI();
+            r.city.blockSize = getF(), r.city.roadW = getF(), r.city.sidewalk = getF();
+            r.city.startX = getF(), r.city.startY = getF();
+            r.city.lotsX = getI(), r.city.lotsY = getI();
+            r.city.seed = getU();
+            r.city.layout = (CityLayout)get8();
+            r.city.jitter = getF(), r.city.arterialEvery = getI(), r.city.arterialW = getF(), r.city.deadEnds = getF();
+            r.fixedStep = getF();
+            r.dispatchMode = get8();
+            r.distanceTable = get8() != 0;
+            break;
+        case EventLog::HOSPITAL:
+        {
+            r.location = getV();
+            r.onSceneDuration = getF();
+            uint32_t n = getU();
+            r.parking.resize(min<size_t>(n, (pos - cur) / 8));
+            for (auto &p : r.parking)
+                p = getV();
+            break;
+        }
+        case EventLog::INTAKE:
+            r.emergency = Emergency{};
+            r.emergency.assignedHospital = getI();
+            r.emergency.priority = getI();
+            r.emergency.location = getV();
+            r.emergency.patient.houseNumber = getI();
+            r.emergency.patient.age = getI();
+            r.emergency.patient.name = getS();
+            r.emergency.patient.severity = getS();
+            r.emergency.patient.desc = getS();
+            break;
+        case EventLog::ROUTED:
+            r.hospital = getI(), r.id = getI();
+            break;
+        case EventLog::ASSIGN:
+            r.hospital = getI(), r.id = getI(), r.ambulanceId = getI();
+            break;
+        case EventLog::STATUS:
+            r.hospital = getI(), r.ambulanceId = getI();
+            r.status = (Ambulance::Status)get8();
+            break;
+        case EventLog::LEND:
+            r.hospital = getI(), r.id = getI(), r.toHospital = getI(), r.toId = getI();
+            break;
+        case EventLog::CHECKPOINT:
+        case EventLog::END:
+            r.hash = get64();
+            break;
+        default:
+            break; // unknown tags are skipped by size
+        }
+    }
+};
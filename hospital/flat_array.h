@@ -0,0 +1,142 @@
+// Contiguous array that either owns its elements (a vector underneath) or
+// views elements that live elsewhere, typically a memory-mapped city file
+// (city_file.h). Reading and writing elements works the same either way;
+// anything that changes the size first copies a view into owned storage.
+// The static map data (roads, houses, road graph, spatial indexes) is kept
+// in these so a mapped file can be used in place.
+
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+template <typename T>
+class FlatArray
+{
+    static_assert(is_trivially_copyable<T>::value, "FlatArray elements are stored as raw bytes");
+
+public:
+    FlatArray() = default;
+    FlatArray(const vector<T> &v) : own(v) { sync(); } // implicit: vector arguments still work
+    FlatArray(const FlatArray &o) { *this = o; }
+    FlatArray(FlatArray &&o) noexcept { *this = move(o); }
+
+    // A copy of a view is another view of the same memory.
+    FlatArray &operator=(const FlatArray &o)
+    {
+        if (this == &o)
+            return *this;
+        if (o.isView())
+        {
+            own.clear();
+            ptr = o.ptr;
+            n = o.n;
+        }
+        else
+        {
+            own = o.own;
+            sync();
+        }
+        return *this;
+    }
+
+    FlatArray &operator=(FlatArray &&o) noexcept
+    {
+        bool view = o.isView();
+        own = move(o.own);
+        if (view)
+        {
+            ptr = o.ptr;
+            n = o.n;
+        }
+        else
+            sync();
+        o.own.clear();
+        o.sync();
+        return *this;
+    }
+
+    // Use `count` elements at p in place; the memory must outlive the array.
+    void view(T *p, size_t count)
+    {
+        own.clear();
+        own.shrink_to_fit();
+        ptr = p;
+        n = count;
+    }
+    bool isView() const { return ptr != nullptr && ptr != own.data(); }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    T *data() { return ptr; }
+    const T *data() const { return ptr; }
+    T &operator[](size_t i) { return ptr[i]; }
+    const T &operator[](size_t i) const { return ptr[i]; }
+    T &front() { return ptr[0]; }
+    const T &front() const { return ptr[0]; }
+    T &back() { return ptr[n - 1]; }
+    const T &back() const { return ptr[n - 1]; }
+    T *begin() { return ptr; }
+    T *end() { return ptr + n; }
+    const T *begin() const { return ptr; }
+    const T *end() const { return ptr + n; }
+
+    void clear()
+    {
+        own.clear();
+        sync();
+    }
+    void reserve(size_t count)
+    {
+        detach();
+        own.reserve(count);
+        sync();
+    }
+    void resize(size_t count)
+    {
+        detach();
+        own.resize(count);
+        sync();
+    }
+    void resize(size_t count, const T &v)
+    {
+        detach();
+        own.resize(count, v);
+        sync();
+    }
+    void assign(size_t count, const T &v)
+    {
+        own.assign(count, v);
+        sync();
+    }
+    void push_back(const T &v)
+    {
+        detach();
+        own.push_back(v);
+        sync();
+    }
+
+private:
+    vector<T> own;
+    T *ptr = nullptr;
+    size_t n = 0;
+
+    void sync()
+    {
+        ptr = own.data();
+        n = own.size();
+    }
+
+    // take a private copy of viewed elements before changing the size
+    void detach()
+    {
+        if (isView())
+        {
+            own.assign(ptr, ptr + n);
+            sync();
+        }
+    }
+};
@@ -0,0 +1,210 @@
+// Structure-of-arrays fleet storage. Fields read on every position query
+// (position, speed, status, route) live in contiguous arrays; routes share
+// one pooled buffer; crew/patient assignment data is kept apart.
+//
+// Units move analytically: a routed unit left its start point at departAt
+// and is wherever speed * motionFactor * elapsed time puts it along the
+// route (positionAt), so nothing is stepped per tick.
+
+#pragma once
+
+#include "sim_types.h"
+#include "sim_clock.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// ----------------------------- Path pool ----------------------------------
+
+// One Vec2 buffer carved into power-of-two blocks with a free list per size
+// class, so re-routing a vehicle recycles its old block instead of hitting
+// the allocator. A parallel float buffer holds the distance along the route
+// to each point.
+class PathPool
+{
+public:
+    // Returns the offset of a block holding at least n points; cap receives
+    // the block capacity to hand back to release().
+    int alloc(int n, int &cap)
+    {
+        int cls = sizeClass(n);
+        cap = minBlock << cls;
+        if (cls >= (int)freeBlocks.size())
+            freeBlocks.resize(cls + 1);
+        if (!freeBlocks[cls].empty())
+        {
+            int off = freeBlocks[cls].back();
+            freeBlocks[cls].pop_back();
+            return off;
+        }
+        int off = (int)data.size();
+        data.resize(data.size() + cap);
+        dist.resize(data.size());
+        return off;
+    }
+
+    void release(int off, int cap)
+    {
+        if (cap <= 0)
+            return;
+        freeBlocks[sizeClass(cap)].push_back(off);
+    }
+
+    Vec2 *at(int off) { return data.data() + off; }
+    const Vec2 *at(int off) const { return data.data() + off; }
+    float *distAt(int off) { return dist.data() + off; }
+    const float *distAt(int off) const { return dist.data() + off; }
+    size_t capacity() const { return data.size(); }
+
+private:
+    static const int minBlock = 8;
+    vector<Vec2> data;
+    vector<float> dist;
+    vector<vector<int>> freeBlocks;
+
+    static int sizeClass(int n)
+    {
+        int cls = 0;
+        while ((minBlock << cls) < n)
+            cls++;
+        return cls;
+    }
+};
+
+// ----------------------------- Fleet store --------------------------------
+
+// Assignment data only read on status changes and by the UI.
+struct AmbulanceTask
+{
+    int emergencyId = -1;
+    string patientName;
+    int houseId = -1;
+    SimMicros dispatchedAt = 0, arrivedAt = 0;
+};
+
+struct FleetStore
+{
+    using Status = Ambulance::Status;
+
+    static constexpr float returnFactor = 0.8f; // returning units drive at 80% speed
+
+    // hot: read by every position query
+    vector<float> x, y; // position, or the start of the current route
+    vector<float> speed;
+    vector<Status> status;
+    vector<int> pathLen;
+
+    // warm: status transitions
+    vector<float> parkX, parkY;
+    vector<SimMicros> departAt; // start of the current route
+    vector<SimMicros> due;      // time of the unit's next event (Hospital)
+    vector<int> pathOff, pathCap;
+
+    // cold
+    vector<int> id;
+    vector<AmbulanceTask> task;
+
+    PathPool paths;
+
+    int size() const { return (int)x.size(); }
+
+    int add(const Ambulance &a)
+    {
+        x.push_back(a.pos.x);
+        y.push_back(a.pos.y);
+        speed.push_back(a.speed);
+        status.push_back(a.status);
+        pathLen.push_back(0);
+        parkX.push_back(a.parkingPos.x);
+        parkY.push_back(a.parkingPos.y);
+        departAt.push_back(0);
+        due.push_back(0);
+        pathOff.push_back(0);
+        pathCap.push_back(0);
+        id.push_back(a.id);
+        task.push_back({a.assignedEmergencyId, "", a.assignedHouseId});
+        return size() - 1;
+    }
+
+    Vec2 pos(int i) const { return Vec2{x[i], y[i]}; }
+    Vec2 parking(int i) const { return Vec2{parkX[i], parkY[i]}; }
+    void setPos(int i, Vec2 p)
+    {
+        x[i] = p.x;
+        y[i] = p.y;
+    }
+
+    void setStatus(int i, Status s) { status[i] = s; }
+
+    // Route points of vehicle i, [0, pathLen[i]).
+    const Vec2 *path(int i) const { return paths.at(pathOff[i]); }
+    // Distance from the route's start point to each route point.
+    const float *pathDist(int i) const { return paths.distAt(pathOff[i]); }
+    float routeLength(int i) const { return pathLen[i] ? pathDist(i)[pathLen[i] - 1] : 0.0f; }
+
+    // Speed multiplier while driving a route in the current status.
+    float motionFactor(int i) const { return status[i] == Status::RETURNING ? returnFactor : 1.0f; }
+
+    // Where vehicle i is at sim time t: its position (the route's start)
+    // moved speed * motionFactor * (t - departAt) along the route. `next`
+    // receives the first route point not yet passed.
+    Vec2 positionAt(int i, SimMicros t, int *next = nullptr) const
+    {
+        int n = pathLen[i];
+        if (n == 0 || t <= departAt[i])
+        {
+            if (next)
+                *next = 0;
+            return pos(i);
+        }
+        const float *d = pathDist(i);
+        float s = (float)toSeconds(t - departAt[i]) * speed[i] * motionFactor(i);
+        int k = (int)(upper_bound(d, d + n, s) - d);
+        if (next)
+            *next = k;
+        if (k >= n)
+            return path(i)[n - 1];
+        Vec2 a = k ? path(i)[k - 1] : pos(i), b = path(i)[k];
+        float from = k ? d[k - 1] : 0.0f, len = d[k] - from;
+        float f = len > 0 ? (s - from) / len : 1.0f;
+        return Vec2{a.x + (b.x - a.x) * f, a.y + (b.y - a.y) * f};
+    }
+
+    void setPath(int i, const Vec2 *pts, int n)
+    {
+        if (n > pathCap[i])
+        {
+            paths.release(pathOff[i], pathCap[i]);
+            pathOff[i] = paths.alloc(n, pathCap[i]);
+        }
+        Vec2 *dst = paths.at(pathOff[i]);
+        float *d = paths.distAt(pathOff[i]);
+        Vec2 prev = pos(i);
+        float run = 0.0f;
+        for (int k = 0; k < n; ++k)
+        {
+            dst[k] = pts[k];
+            run += sqrtf((pts[k].x - prev.x) * (pts[k].x - prev.x) + (pts[k].y - prev.y) * (pts[k].y - prev.y));
+            d[k] = run;
+            prev = pts[k];
+        }
+        pathLen[i] = n;
+    }
+
+    void clearPath(int i) { pathLen[i] = 0; }
+
+    // Materialise one vehicle as the classic record (UI, tools, debugging).
+    Ambulance get(int i) const
+    {
+        Ambulance a;
+        a.id = id[i];
+        a.pos = pos(i);
+        a.parkingPos = parking(i);
+        a.speed = speed[i];
+        a.status = status[i];
+        a.assignedEmergencyId = task[i].emergencyId;
+        a.assignedHouseId = task[i].houseId;
+        return a;
+    }
+};
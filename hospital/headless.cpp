@@ -0,0 +1,316 @@
+// Headless fleet simulation driver (no display required)
+// Build: make headless   (or g++ -std=c++17 -O2 headless.cpp -o headless)
+//
+// Usage: headless [--ticks N | --duration SIM_SECONDS] [--dt SECONDS] [--rate CALLS_PER_SIM_SECOND] [--seed S]
+//                 [--blocks N] [--hospitals N] [--units PER_HOSPITAL]
+//                 [--dispatch greedy|batch] [--record FILE]
+//        headless --city SPEC [--ticks N] ...   generated city, see city_gen.h;
+//                                               SPEC replaces --blocks/--hospitals/--units
+//        headless --load-city FILE [--ticks N] ...   mapped city file, see city_file.h
+//        --save-city FILE   also write the city and hospitals of the run to FILE
+//        --distances FILE   rank units through an all-pairs distance table
+//                           (distance_table.h), mapped from FILE or built and cached there
+//        --profile 1        print per-stage timings (profiler.h) at the end
+//        --trace FILE       write a Chrome trace of the run's stages to FILE
+//        --metrics FILE     write the run's metrics (metrics.h) to FILE, Prometheus text
+//        --metrics-port N   serve them on http://127.0.0.1:N/metrics while running
+//        headless --replay FILE   rerun a recorded session and verify it
+
+#include "city_file.h"
+#include "metrics_server.h"
+#include "replay.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+using namespace std;
+
+struct HeadlessOptions
+{
+    long long ticks = 100000;
+    double duration = 0.0; // sim seconds; replaces ticks when set
+    float dt = 1.0f / 120.0f;
+    double rate = 0.5;
+    unsigned seed = 1;
+    int blocks = 3;
+    int hospitals = 1; // 1 = the GUI's single hospital above the map
+    int units = 4;
+    DispatchMode dispatch = DispatchMode::GREEDY;
+    string record, replay, city, saveCity, loadCity, trace, metrics, distances;
+    int metricsPort = 0;
+    bool profile = false;
+    bool invalid = false; // an option value was refused
+};
+
+static HeadlessOptions parseOptions(int argc, char **argv)
+{
+    HeadlessOptions o;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (!strcmp(argv[i], "--ticks"))
+            o.ticks = atoll(argv[i + 1]);
+        else if (!strcmp(argv[i], "--duration"))
+            o.duration = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--dt"))
+            o.dt = (float)atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--rate"))
+            o.rate = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--seed"))
+            o.seed = (unsigned)strtoul(argv[i + 1], nullptr, 10);
+        else if (!strcmp(argv[i], "--blocks"))
+            o.blocks = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--hospitals"))
+            o.hospitals = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--units"))
+            o.units = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--dispatch"))
+        {
+            if (!parseDispatchMode(argv[i + 1], o.dispatch))
+            {
+                fprintf(stderr, "--dispatch is greedy or batch\n");
+                o.invalid = true;
+            }
+        }
+        else if (!strcmp(argv[i], "--record"))
+            o.record = argv[i + 1];
+        else if (!strcmp(argv[i], "--replay"))
+            o.replay = argv[i + 1];
+        else if (!strcmp(argv[i], "--city"))
+            o.city = argv[i + 1];
+        else if (!strcmp(argv[i], "--save-city"))
+            o.saveCity = argv[i + 1];
+        else if (!strcmp(argv[i], "--load-city"))
+            o.loadCity = argv[i + 1];
+        else if (!strcmp(argv[i], "--distances"))
+            o.distances = argv[i + 1];
+        else if (!strcmp(argv[i], "--profile"))
+            o.profile = atoi(argv[i + 1]) != 0;
+        else if (!strcmp(argv[i], "--trace"))
+            o.trace = argv[i + 1];
+        else if (!strcmp(argv[i], "--metrics"))
+            o.metrics = argv[i + 1];
+        else if (!strcmp(argv[i], "--metrics-port"))
+            o.metricsPort = atoi(argv[i + 1]);
+        else
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+    }
+    return o;
+}
+
+static int runReplay(const string &path)
+{
+    vector<unsigned char> bytes;
+    if (!EventLogReader::loadFile(path, bytes))
+    {
+        fprintf(stderr, "cannot read %s\n", path.c_str());
+        return 1;
+    }
+    auto t0 = chrono::steady_clock::now();
+    ReplayResult r = replayLog(bytes);
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    printf("replayed     %lld ticks, %d emergencies, %d records%s\n", r.ticks, r.emergencies, r.records,
+           r.unclosed ? " (log was not closed)" : "");
+    printf("state hash   %016llx (recorded %016llx)\n", (unsigned long long)r.hash, (unsigned long long)r.expectedHash);
+    printf("wall time    %.3f s (%.0f ticks/s)\n", wall, wall > 0 ? r.ticks / wall : 0.0);
+    if (!r.ok)
+    {
+        printf("MISMATCH     %s\n", r.error.c_str());
+        return 2;
+    }
+    printf("replay OK\n");
+    return 0;
+}
+
+static void printLatency(const char *label, const HistogramSnapshot &s)
+{
+    printf("%-12s %8llu calls  mean %7.2f  p50 %7.2f  p90 %7.2f  p99 %7.2f s\n", label, (unsigned long long)s.count,
+           s.mean() * 1e-6, s.quantile(0.5) * 1e-6, s.quantile(0.9) * 1e-6, s.quantile(0.99) * 1e-6);
+}
+
+int main(int argc, char **argv)
+{
+    HeadlessOptions opt = parseOptions(argc, argv);
+    if (opt.invalid)
+        return 1;
+    if (!opt.replay.empty())
+        return runReplay(opt.replay);
+    if (!(opt.rate >= 0.0))
+    {
+        fprintf(stderr, "--rate must be 0 (no calls) or more\n");
+        return 1;
+    }
+    if (opt.blocks < 1 || opt.units < 1)
+    {
+        fprintf(stderr, "--blocks and --units must be at least 1\n");
+        return 1;
+    }
+
+    CitySpec spec;
+    spec.cfg.seed = opt.seed;
+    spec.cfg.blocksX = spec.cfg.blocksY = opt.blocks;
+    spec.hospitals = opt.hospitals;
+    spec.units = opt.units;
+    string error;
+    if (!opt.city.empty() && !loadCitySpec(opt.city, spec, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    auto g0 = chrono::steady_clock::now();
+    CityMap city;
+    vector<HospitalSite> sites;
+    if (opt.loadCity.empty())
+        city = buildCity(spec.cfg, spec.threads);
+    else if (!loadCityFile(opt.loadCity, city, sites, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    Simulation sim(move(city), opt.dt);
+    if (opt.duration > 0)
+        opt.ticks = (toMicros(opt.duration) + sim.fixedStepMicros() - 1) / sim.fixedStepMicros();
+    double genWall = chrono::duration<double>(chrono::steady_clock::now() - g0).count();
+    sim.setDispatchMode(opt.dispatch);
+    double tableWall = 0.0;
+    if (!opt.distances.empty())
+    {
+        auto t0 = chrono::steady_clock::now();
+        auto table = openDistanceTable(opt.distances, sim.map().graph, spec.threads, error);
+        if (!table)
+        {
+            fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        sim.setDistanceTable(table);
+        tableWall = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    }
+    if (!opt.loadCity.empty())
+        addHospitals(sim, sites);
+    else if (spec.hospitals == 1 && spec.units == 4 && spec.cfg.layout == CityLayout::GRID)
+        placeDefaultHospital(sim);
+    else
+        placeHospitalGrid(sim, spec.hospitals, spec.units);
+    if (sim.getHospitals().empty())
+    {
+        fprintf(stderr, "no hospitals to take calls: --hospitals must be at least 1\n");
+        return 1;
+    }
+    if (sim.map().houses.empty())
+    {
+        fprintf(stderr, "no houses to place calls at\n");
+        return 1;
+    }
+    if (!opt.saveCity.empty() && !saveCityFile(opt.saveCity, sim.map(), hospitalSites(sim), error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    unique_ptr<EventLog> log;
+    if (!opt.record.empty())
+    {
+        log.reset(new EventLog(opt.record));
+        if (!log->ok())
+        {
+            fprintf(stderr, "cannot write %s\n", opt.record.c_str());
+            return 1;
+        }
+        sim.attachLog(log.get());
+    }
+
+    MetricsRegistry registry;
+    SimMetrics simMetrics(registry);
+    MetricsServer server;
+    bool metricsOn = !opt.metrics.empty() || opt.metricsPort > 0;
+    if (metricsOn)
+        sim.attachMetrics(&simMetrics);
+    if (opt.metricsPort > 0 && !server.start(registry, opt.metricsPort, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    const FlatArray<House> &houses = sim.map().houses;
+    const char *severities[] = {"Critical", "High", "Normal"};
+    mt19937 rng(opt.seed);
+    exponential_distribution<double> interArrival(opt.rate > 0 ? opt.rate : 1.0);
+    uniform_int_distribution<int> pickHouse(0, (int)houses.size() - 1);
+    uniform_int_distribution<int> pickPriority(1, 3);
+    double nextCall = opt.rate > 0 ? interArrival(rng) : numeric_limits<double>::infinity(); // rate 0: no calls
+
+    Profiler &prof = Profiler::instance();
+    Profiler::enable(opt.profile || !opt.trace.empty());
+    if (!opt.trace.empty())
+        prof.startTrace();
+    auto t0 = chrono::steady_clock::now();
+    while (sim.ticks() < opt.ticks)
+    {
+        if (Profiler::enabled())
+            prof.collect(); // at most 1024 steps of four zones each, well inside a ring
+        while (nextCall <= sim.time())
+        {
+            const House &h = houses[pickHouse(rng)];
+            Emergency em;
+            em.priority = pickPriority(rng);
+            em.patient.name = "P" + to_string(sim.emergencyCount() + 1);
+            em.patient.severity = severities[em.priority - 1];
+            em.patient.houseNumber = h.id;
+            em.location = h.frontDoor();
+            sim.submit(em);
+            nextCall += interArrival(rng);
+        }
+        // quiet ticks up to the next call are skipped where nothing is due
+        sim.runUntil(min({opt.ticks, sim.tickAt(nextCall), sim.ticks() + 1024}));
+    }
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    sim.closeLog();
+
+    int handled = 0, pending = 0;
+    for (auto &h : sim.getHospitals())
+    {
+        handled += h.handled();
+        pending += h.pendingCount();
+    }
+    if (!opt.city.empty() || !opt.loadCity.empty())
+        printf("city         %zu houses, %zu roads, %d intersections, %s in %.3f s\n", sim.map().houses.size(),
+               sim.map().roads.size(), sim.map().graph.nodeCount(), opt.loadCity.empty() ? "built" : "mapped", genWall);
+    if (const DistanceTable *t = sim.distanceTable())
+        printf("distances    %d x %d table, %.1f MB, %s in %.3f s\n", t->nodeCount(), t->nodeCount(), t->bytes() / 1e6,
+               t->mapped() ? "mapped" : "built", tableWall);
+    printf("ticks        %lld\n", sim.ticks());
+    printf("sim time     %.1f s\n", sim.time());
+    printf("emergencies  %d (handled %d, pending %d)\n", sim.emergencyCount(), handled, pending);
+    printf("hospitals    %d (%d calls lent between hospitals)\n", (int)sim.getHospitals().size(), sim.getNetwork().lentCount());
+    printf("wall time    %.3f s (%.0f ticks/s)\n", wall, wall > 0 ? sim.ticks() / wall : 0.0);
+    if (metricsOn)
+    {
+        printLatency("to dispatch", registry.histogramSnapshot("ems_call_to_dispatch_seconds"));
+        for (int p = 1; p <= SimMetrics::priorities; ++p)
+        {
+            string labels = "priority=\"" + to_string(p) + "\"";
+            string label = "  wait p" + to_string(p);
+            printLatency(label.c_str(), registry.histogramSnapshot("ems_queue_wait_seconds", &labels));
+        }
+        printLatency("to scene", registry.histogramSnapshot("ems_dispatch_to_scene_seconds"));
+        printLatency("on scene", registry.histogramSnapshot("ems_on_scene_seconds"));
+        uint64_t unitTime = simMetrics.unitMicros.value();
+        printf("utilization  %.1f %% of unit time busy\n", unitTime ? 100.0 * simMetrics.busyUnitMicros.value() / unitTime : 0.0);
+    }
+    if (!opt.metrics.empty() && !registry.writeFile(opt.metrics, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    prof.collect();
+    if (opt.profile)
+        for (auto &z : prof.stats())
+            printf("zone         %-18s %10lld calls %10.3f us mean  p50 %8.3f  p99 %8.3f us (last %d)\n", z.name, z.count,
+                   z.count ? z.totalMicros / z.count : 0.0, z.p50, z.p99, Profiler::window);
+    if (!opt.trace.empty() && !prof.stopTrace(opt.trace, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+// Static 2-d tree over hospital locations. Rebuilt whenever a hospital is
+// added (rare); answers k-nearest queries in O(log H + k) so routing a call
+// never scans the whole network.
+
+#pragma once
+
+#include "sim_types.h"
+
+#include <algorithm>
+
+class HospitalLocator
+{
+public:
+    struct Hit
+    {
+        int hospital = -1;
+        float dist2 = 0.0f;
+    };
+
+    void build(const vector<Vec2> &locations)
+    {
+        nodes.clear();
+        for (int i = 0; i < (int)locations.size(); ++i)
+            nodes.push_back({locations[i], i});
+        buildRange(0, (int)nodes.size(), 0);
+    }
+
+    int size() const { return (int)nodes.size(); }
+
+    // Up to k hospitals closest to p (Euclidean), nearest first. `exclude`
+    // skips one hospital, e.g. the one asking for help.
+    int kNearest(Vec2 p, int k, vector<Hit> &out, int exclude = -1) const
+    {
+        out.clear();
+        if (k > 0)
+            search(0, (int)nodes.size(), 0, p, k, exclude, out);
+        return (int)out.size();
+    }
+
+private:
+    struct Node
+    {
+        Vec2 p;
+        int hospital;
+    };
+
+    // implicit balanced tree: the median of [lo, hi) sits at (lo + hi) / 2,
+    // split on x at even depths and on y at odd ones
+    vector<Node> nodes;
+
+    static bool closer(const Hit &a, const Hit &b) { return a.dist2 < b.dist2; }
+    static float axisOf(Vec2 p, int depth) { return (depth & 1) ? p.y : p.x; }
+
+    void buildRange(int lo, int hi, int depth)
+    {
+        if (hi - lo <= 1)
+            return;
+        int mid = (lo + hi) / 2;
+        nth_element(nodes.begin() + lo, nodes.begin() + mid, nodes.begin() + hi,
+                    [depth](const Node &a, const Node &b) { return axisOf(a.p, depth) < axisOf(b.p, depth); });
+        buildRange(lo, mid, depth + 1);
+        buildRange(mid + 1, hi, depth + 1);
+    }
+
+    // `out` holds the best k so far, sorted by dist2
+    void search(int lo, int hi, int depth, Vec2 p, int k, int exclude, vector<Hit> &out) const
+    {
+        if (lo >= hi)
+            return;
+        int mid = (lo + hi) / 2;
+        const Node &n = nodes[mid];
+        if (n.hospital != exclude)
+        {
+            float dx = n.p.x - p.x, dy = n.p.y - p.y;
+            float d2 = dx * dx + dy * dy;
+            if ((int)out.size() < k || d2 < out.back().dist2)
+            {
+                // k is small: insertion into the sorted list beats a heap
+                if ((int)out.size() == k)
+                    out.pop_back();
+                out.insert(upper_bound(out.begin(), out.end(), Hit{n.hospital, d2}, closer), Hit{n.hospital, d2});
+            }
+        }
+        float split = axisOf(p, depth) - axisOf(n.p, depth);
+        bool leftFirst = split < 0.0f;
+        if (leftFirst)
+            search(lo, mid, depth + 1, p, k, exclude, out);
+        else
+            search(mid + 1, hi, depth + 1, p, k, exclude, out);
+        // the far side can only help if the splitting plane is within the k-th distance
+        if ((int)out.size() < k || split * split < out.back().dist2)
+        {
+            if (leftFirst)
+                search(mid + 1, hi, depth + 1, p, k, exclude, out);
+            else
+                search(lo, mid, depth + 1, p, k, exclude, out);
+        }
+    }
+};
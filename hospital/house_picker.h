@@ -0,0 +1,108 @@
+// Which house is under a point (mouse picking). House bodies are bucketed
+// into a uniform grid, each house in every cell its body overlaps, so a
+// lookup scans the few houses of one cell instead of the whole city.
+
+#pragma once
+
+#include "flat_array.h"
+#include "sim_types.h"
+
+#include <algorithm>
+#include <cmath>
+
+class HousePicker
+{
+public:
+    void build(const FlatArray<House> &houses)
+    {
+        bodies.clear();
+        cellStart.clear();
+        cellHouses.clear();
+        if (houses.empty())
+            return;
+        bodies.reserve(houses.size());
+        float maxX = houses[0].body.x, maxY = houses[0].body.y, avg = 0.0f;
+        minX = maxX;
+        minY = maxY;
+        for (auto &h : houses)
+        {
+            const Rect &b = h.body;
+            bodies.push_back(b);
+            minX = min(minX, b.x);
+            minY = min(minY, b.y);
+            maxX = max(maxX, b.x + b.width);
+            maxY = max(maxY, b.y + b.height);
+            avg += max(b.width, b.height);
+        }
+        // cells about twice a house across: a house touches at most 4 cells
+        cellSize = max(1.0f, 2.0f * avg / houses.size());
+        gridW = (int)((maxX - minX) / cellSize) + 1;
+        gridH = (int)((maxY - minY) / cellSize) + 1;
+
+        // counting sort into CSR buckets
+        cellStart.assign((size_t)gridW * gridH + 1, 0);
+        forEachCell([&](int c, int) { cellStart[c + 1]++; });
+        for (size_t c = 1; c < cellStart.size(); ++c)
+            cellStart[c] += cellStart[c - 1];
+        cellHouses.resize(cellStart.back());
+        vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        forEachCell([&](int c, int h) { cellHouses[fill[c]++] = h; });
+    }
+
+    // Index of the house whose body contains p, -1 if none.
+    int pick(Vec2 p) const
+    {
+        if (bodies.empty())
+            return -1;
+        int cx = (int)floorf((p.x - minX) / cellSize), cy = (int)floorf((p.y - minY) / cellSize);
+        if (cx < 0 || cy < 0 || cx >= gridW || cy >= gridH)
+            return -1;
+        int c = cy * gridW + cx;
+        for (int k = cellStart[c]; k < cellStart[c + 1]; ++k)
+        {
+            const Rect &b = bodies[cellHouses[k]];
+            if (p.x >= b.x && p.x < b.x + b.width && p.y >= b.y && p.y < b.y + b.height) // as CheckCollisionPointRec
+                return cellHouses[k];
+        }
+        return -1;
+    }
+
+    // Every stored member in a fixed order, see RoadGraph::visitStorage.
+    template <typename Self, typename V>
+    static void visitStorage(Self &p, V &v)
+    {
+        v.array("PBOD", p.bodies);
+        v.value("PMNX", p.minX);
+        v.value("PMNY", p.minY);
+        v.value("PCEL", p.cellSize);
+        v.value("PGW ", p.gridW);
+        v.value("PGH ", p.gridH);
+        v.array("PCST", p.cellStart);
+        v.array("PCHS", p.cellHouses);
+    }
+
+    bool consistent() const
+    {
+        return bodies.empty() || (cellStart.size() == (size_t)gridW * gridH + 1 && (size_t)cellStart.back() == cellHouses.size());
+    }
+
+private:
+    FlatArray<Rect> bodies; // copy of the house bodies, kept dense for the scan
+    float minX = 0, minY = 0, cellSize = 1;
+    int gridW = 0, gridH = 0;
+    FlatArray<int> cellStart, cellHouses; // houses of cell c: cellHouses[cellStart[c] .. cellStart[c + 1])
+
+    template <typename F>
+    void forEachCell(F &&f) const
+    {
+        for (int h = 0; h < (int)bodies.size(); ++h)
+        {
+            const Rect &b = bodies[h];
+            int x0 = (int)((b.x - minX) / cellSize), x1 = (int)((b.x + b.width - minX) / cellSize);
+            int y0 = (int)((b.y - minY) / cellSize), y1 = (int)((b.y + b.height - minY) / cellSize);
+            for (int cy = y0; cy <= min(y1, gridH - 1); ++cy)
+                for (int cx = x0; cx <= min(x1, gridW - 1); ++cx)
+                    f(cy * gridW + cx, h);
+        }
+    }
+};
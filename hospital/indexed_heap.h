@@ -0,0 +1,186 @@
+// Binary min-heap over integer ids with a position map, so any element can
+// be found, erased or re-keyed in O(log n) without rebuilding the heap.
+// Entries live in slots that are recycled once erased, so storage follows
+// the number of live entries, not the largest id ever pushed.
+
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+using namespace std;
+
+template <typename Key, typename Less = less<Key>>
+class IndexedHeap
+{
+public:
+    bool empty() const { return heap.empty(); }
+    int size() const { return (int)heap.size(); }
+    bool contains(int id) const { return slotOf.count(id) != 0; }
+
+    int topId() const { return idOf[heap.front()]; }
+    const Key &topKey() const { return keys[heap.front()]; }
+    const Key &key(int id) const { return keys[slotOf.at(id)]; }
+
+    // Slots allocated so far: the most entries ever live at once.
+    int capacity() const { return (int)keys.size(); }
+
+    // The k smallest ids in key order, without touching the heap: a small
+    // frontier heap over heap slots is expanded from the root, so the cost is
+    // O(k log k) and nothing is allocated once the buffers have grown.
+    int topK(int k, vector<int> &out) const
+    {
+        out.clear();
+        frontier.clear();
+        auto after = [this](int a, int b) { return before(b, a); };
+        if (!heap.empty() && k > 0)
+            frontier.push_back(0);
+        while (!frontier.empty() && (int)out.size() < k)
+        {
+            pop_heap(frontier.begin(), frontier.end(), after);
+            int slot = frontier.back();
+            frontier.pop_back();
+            out.push_back(idOf[heap[slot]]);
+            for (int child = 2 * slot + 1; child <= 2 * slot + 2 && child < (int)heap.size(); ++child)
+            {
+                frontier.push_back(child);
+                push_heap(frontier.begin(), frontier.end(), after);
+            }
+        }
+        return (int)out.size();
+    }
+
+    void push(int id, const Key &k)
+    {
+        auto found = slotOf.find(id);
+        if (found != slotOf.end())
+        {
+            rekey(found->second, k);
+            return;
+        }
+        int slot;
+        if (!freeSlots.empty())
+        {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        else
+        {
+            slot = (int)keys.size();
+            keys.emplace_back();
+            idOf.push_back(0);
+            pos.push_back(0);
+        }
+        slotOf.emplace(id, slot);
+        keys[slot] = k;
+        idOf[slot] = id;
+        pos[slot] = (int)heap.size();
+        heap.push_back(slot);
+        siftUp(pos[slot]);
+    }
+
+    int pop()
+    {
+        int id = topId();
+        removeAt(0);
+        return id;
+    }
+
+    bool erase(int id)
+    {
+        auto found = slotOf.find(id);
+        if (found == slotOf.end())
+            return false;
+        removeAt(pos[found->second]);
+        return true;
+    }
+
+    // Change the key of an element already in the heap, in either direction.
+    void update(int id, const Key &k) { rekey(slotOf.at(id), k); }
+
+    void clear()
+    {
+        heap.clear();
+        slotOf.clear();
+        freeSlots.clear();
+        for (int slot = (int)keys.size() - 1; slot >= 0; --slot)
+            freeSlots.push_back(slot);
+    }
+
+private:
+    vector<int> heap;               // slots in heap order
+    vector<int> pos;                // slot -> index in heap
+    vector<Key> keys;               // slot -> key
+    vector<int> idOf;               // slot -> id
+    vector<int> freeSlots;          // slots not in the heap, reused first
+    unordered_map<int, int> slotOf; // id -> slot, live entries only
+    Less less_;
+    mutable vector<int> frontier;   // topK scratch
+
+    bool before(int a, int b) const { return less_(keys[heap[a]], keys[heap[b]]); }
+
+    void rekey(int slot, const Key &k)
+    {
+        int i = pos[slot];
+        bool up = less_(k, keys[slot]);
+        keys[slot] = k;
+        if (up)
+            siftUp(i);
+        else
+            siftDown(i);
+    }
+
+    void swapAt(int a, int b)
+    {
+        swap(heap[a], heap[b]);
+        pos[heap[a]] = a;
+        pos[heap[b]] = b;
+    }
+
+    void siftUp(int i)
+    {
+        while (i > 0)
+        {
+            int parent = (i - 1) / 2;
+            if (!before(i, parent))
+                break;
+            swapAt(i, parent);
+            i = parent;
+        }
+    }
+
+    void siftDown(int i)
+    {
+        int n = (int)heap.size();
+        for (;;)
+        {
+            int l = 2 * i + 1, r = l + 1, best = i;
+            if (l < n && before(l, best))
+                best = l;
+            if (r < n && before(r, best))
+                best = r;
+            if (best == i)
+                break;
+            swapAt(i, best);
+            i = best;
+        }
+    }
+
+    void removeAt(int i)
+    {
+        int slot = heap[i];
+        int last = (int)heap.size() - 1;
+        if (i != last)
+            swapAt(i, last);
+        heap.pop_back();
+        slotOf.erase(idOf[slot]);
+        freeSlots.push_back(slot);
+        if (i < (int)heap.size())
+        {
+            siftUp(i);
+            siftDown(i);
+        }
+    }
+};
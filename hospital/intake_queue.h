@@ -0,0 +1,105 @@
+// Bounded multi-producer / single-consumer ring for incoming calls. Any
+// number of call-taker threads push; the simulation thread drains it once per
+// tick. Each cell carries a sequence number (Vyukov's bounded queue), so a
+// push is one CAS on the shared tail and a pop touches no shared counter.
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+using namespace std;
+
+template <typename T>
+class IntakeQueue
+{
+public:
+    // Capacity is rounded up to a power of two.
+    explicit IntakeQueue(size_t capacity = 1 << 16)
+    {
+        size_t cap = 2;
+        while (cap < capacity)
+            cap <<= 1;
+        mask = cap - 1;
+        cells.reset(new Cell[cap]);
+        for (size_t i = 0; i < cap; ++i)
+            cells[i].seq.store(i, memory_order_relaxed);
+    }
+
+    IntakeQueue(const IntakeQueue &) = delete;
+    IntakeQueue &operator=(const IntakeQueue &) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Any thread. False when the ring is full; the caller decides whether to
+    // retry or shed the call.
+    bool tryPush(T &&value)
+    {
+        size_t pos = tail.load(memory_order_relaxed);
+        Cell *c;
+        for (;;)
+        {
+            c = &cells[pos & mask];
+            size_t seq = c->seq.load(memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+            if (dif == 0)
+            {
+                if (tail.compare_exchange_weak(pos, pos + 1, memory_order_relaxed))
+                    break;
+            }
+            else if (dif < 0)
+                return false;
+            else
+                pos = tail.load(memory_order_relaxed);
+        }
+        c->value = move(value);
+        c->seq.store(pos + 1, memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. False when empty, or when the next slot has been
+    // claimed but not yet written (it shows up on the next drain).
+    bool tryPop(T &out)
+    {
+        Cell &c = cells[head & mask];
+        size_t seq = c.seq.load(memory_order_acquire);
+        if (seq != head + 1)
+            return false;
+        out = move(c.value);
+        c.seq.store(head + mask + 1, memory_order_release);
+        head++;
+        return true;
+    }
+
+    // Consumer thread only: pop up to `limit` items into f, returns the count.
+    template <typename F>
+    int drain(F &&f, int limit)
+    {
+        int n = 0;
+        while (n < limit && tryPop(scratch))
+        {
+            f(scratch);
+            n++;
+        }
+        return n;
+    }
+
+    // Consumer thread only; approximate while producers are pushing.
+    size_t sizeApprox() const { return tail.load(memory_order_relaxed) - head; }
+    bool empty() const { return sizeApprox() == 0; }
+
+private:
+    struct Cell
+    {
+        atomic<size_t> seq;
+        T value;
+    };
+
+    unique_ptr<Cell[]> cells;
+    size_t mask = 0;
+    alignas(64) atomic<size_t> tail{0}; // next slot producers claim
+    alignas(64) size_t head = 0;        // next slot the consumer reads
+    T scratch;                          // drain buffer, keeps string capacity
+};
@@ -0,0 +1,285 @@
+// Text labels for the GUI, built once and reused across frames. Each label
+// sits in a slot (which entity, which of its labels) together with the key
+// it was built from (the state it shows) and its measured width, and is only
+// rebuilt and re-measured when that key changes. Looking up an existing slot
+// does not allocate and a rebuild reuses the slot's string capacity, so a
+// frame whose labels did not change makes no heap allocation. No raylib
+// dependency: the text measuring function is passed in.
+
+#pragma once
+
+#include "simulation.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std;
+
+struct Label
+{
+    string text;
+    int width = 0; // pixels at fontSize
+    int fontSize = 0;
+};
+
+// What a label shows; up to three numbers.
+struct LabelKey
+{
+    long long a = 0, b = 0, c = 0;
+    bool operator==(const LabelKey &o) const { return a == o.a && b == o.b && c == o.c; }
+    bool operator!=(const LabelKey &o) const { return !(*this == o); }
+};
+
+class LabelCache
+{
+public:
+    using MeasureFn = int (*)(const char *text, int fontSize);
+
+    explicit LabelCache(MeasureFn measure) : measureText(measure) {}
+
+    static uint64_t slot(unsigned kind, long long id) { return ((uint64_t)kind << 32) | (uint32_t)id; }
+
+    // The label in `slot`; format(string &text) is called to write it only
+    // when `key` differs from the one it was last built for.
+    template <typename F>
+    const Label &get(uint64_t slot, LabelKey key, int fontSize, F &&format)
+    {
+        Entry &e = entries[slot];
+        if (!e.built || e.key != key || e.label.fontSize != fontSize)
+        {
+            e.label.text.clear();
+            format(e.label.text);
+            e.label.fontSize = fontSize;
+            e.label.width = measureText(e.label.text.c_str(), fontSize);
+            e.key = key;
+            e.built = true;
+            rebuilds++;
+        }
+        return e.label;
+    }
+
+    // Appends a number without a temporary string.
+    static void appendInt(string &s, long long v)
+    {
+        char buf[24];
+        int n = snprintf(buf, sizeof(buf), "%lld", v);
+        s.append(buf, n);
+    }
+
+    size_t size() const { return entries.size(); }
+    long long rebuildCount() const { return rebuilds; }
+    void clear() { entries.clear(); }
+
+private:
+    struct Entry
+    {
+        Label label;
+        LabelKey key;
+        bool built = false;
+    };
+
+    MeasureFn measureText;
+    unordered_map<uint64_t, Entry> entries;
+    long long rebuilds = 0;
+};
+
+// ----------------------------- HUD labels ---------------------------------
+
+// Every per-frame label of the GUI, keyed on the snapshot fields it shows.
+class HudLabels
+{
+public:
+    explicit HudLabels(LabelCache::MeasureFn measure) : cache(measure) {}
+
+    // "A3: EN ROUTE" above the unit and in the status list.
+    const Label &unitTag(const AmbulanceView &a)
+    {
+        return cache.get(LabelCache::slot(UNIT_TAG, a.id), {(long long)a.status}, 10, [&](string &s)
+        {
+            s += 'A';
+            LabelCache::appendInt(s, a.id);
+            s += ": ";
+            s += a.getStatusString();
+        });
+    }
+
+    // whole seconds left on scene, "3s"
+    const Label &sceneTimer(const AmbulanceView &a)
+    {
+        int secs = (int)a.onSceneTimer + 1;
+        return cache.get(LabelCache::slot(SCENE_TIMER, a.id), {secs}, 12, [&](string &s)
+        {
+            LabelCache::appendInt(s, secs);
+            s += 's';
+        });
+    }
+
+    const Label &unitTitle(const AmbulanceView &a)
+    {
+        return cache.get(LabelCache::slot(UNIT_TITLE, a.id), {a.id}, 14, [&](string &s)
+        {
+            s += "Ambulance #";
+            LabelCache::appendInt(s, a.id);
+        });
+    }
+
+    // hospital panel line under the title
+    const Label &unitDetail(const AmbulanceView &a)
+    {
+        return cache.get(LabelCache::slot(UNIT_DETAIL, a.id), {(long long)a.status, a.assignedHouseId}, 11, [&](string &s)
+        {
+            switch (a.status)
+            {
+            case Ambulance::Status::IDLE:
+                s += "IDLE - Ready for dispatch";
+                break;
+            case Ambulance::Status::TO_SCENE:
+                s += "EN ROUTE to House #";
+                LabelCache::appendInt(s, a.assignedHouseId);
+                break;
+            case Ambulance::Status::ON_SCENE:
+                s += "ON SCENE at House #";
+                LabelCache::appendInt(s, a.assignedHouseId);
+                break;
+            case Ambulance::Status::RETURNING:
+                s += "RETURNING to hospital";
+                break;
+            }
+        });
+    }
+
+    // a call's patient never changes, so the call id is the key
+    const Label &unitPatient(const AmbulanceView &a)
+    {
+        return cache.get(LabelCache::slot(UNIT_PATIENT, a.id), {a.assignedEmergencyId}, 10, [&](string &s)
+        {
+            s += "Patient: ";
+            s += a.assignedPatientName;
+        });
+    }
+
+    // "Hospital 3:", heading of a hospital's queue preview when there are several
+    const Label &hospitalTitle(int hospital)
+    {
+        return cache.get(LabelCache::slot(HOSPITAL_TITLE, hospital), {hospital}, 14, [&](string &s)
+        {
+            s += "Hospital ";
+            LabelCache::appendInt(s, hospital + 1);
+            s += ':';
+        });
+    }
+
+    // "  #12 Name (Critical)", row of a hospital's queue preview
+    const Label &queueItem(int hospital, int row, const PendingView &p)
+    {
+        return cache.get(LabelCache::slot(QUEUE_ITEM, hospital * WorldSnapshot::queuePreview + row), {p.id}, 11, [&](string &s)
+        {
+            s += "  #";
+            LabelCache::appendInt(s, p.id);
+            s += ' ';
+            s += p.name;
+            s += " (";
+            s += p.severity;
+            s += ')';
+        });
+    }
+
+    const Label &queueMore(int hospital, int more)
+    {
+        return cache.get(LabelCache::slot(QUEUE_MORE, hospital), {more}, 10, [&](string &s)
+        {
+            s += "  +";
+            LabelCache::appendInt(s, more);
+            s += " more...";
+        });
+    }
+
+    const Label &totals(int emergencies, int handled, int pending)
+    {
+        return cache.get(LabelCache::slot(TOTALS, 0), {emergencies, handled, pending}, 16, [&](string &s)
+        {
+            s += "Total Emergencies: ";
+            LabelCache::appendInt(s, emergencies);
+            s += " | Handled: ";
+            LabelCache::appendInt(s, handled);
+            s += " | Pending: ";
+            LabelCache::appendInt(s, pending);
+        });
+    }
+
+    // dashboard metrics, "Fleet busy: 42% | Wait p90: 12s"
+    const Label &fleetStatus(int busyPercent, int waitP90)
+    {
+        return cache.get(LabelCache::slot(FLEET_STATUS, 0), {busyPercent, waitP90}, 16, [&](string &s)
+        {
+            s += "Fleet busy: ";
+            LabelCache::appendInt(s, busyPercent);
+            s += "% | Wait p90: ";
+            LabelCache::appendInt(s, waitP90);
+            s += "s";
+        });
+    }
+
+    // sim clock and pace, "Sim 01:23:45 | 100x" or "Sim 01:23:45 | PAUSED"
+    const Label &simClock(int simSeconds, int speed, bool paused)
+    {
+        return cache.get(LabelCache::slot(SIM_CLOCK, 0), {simSeconds, speed, paused}, 16, [&](string &s)
+        {
+            char hms[32];
+            snprintf(hms, sizeof hms, "Sim %02d:%02d:%02d | ", simSeconds / 3600, simSeconds / 60 % 60, simSeconds % 60);
+            s += hms;
+            if (paused)
+                s += "PAUSED";
+            else
+            {
+                LabelCache::appendInt(s, speed);
+                s += 'x';
+            }
+        });
+    }
+
+    // activity log age, "12s ago"
+    const Label &secondsAgo(int row, int secs)
+    {
+        return cache.get(LabelCache::slot(SECONDS_AGO, row), {secs}, 9, [&](string &s)
+        {
+            LabelCache::appendInt(s, secs);
+            s += "s ago";
+        });
+    }
+
+    const Label &houseHint(int houseId)
+    {
+        return cache.get(LabelCache::slot(HOUSE_HINT, 0), {houseId}, 14, [&](string &s)
+        {
+            s += "House #";
+            LabelCache::appendInt(s, houseId);
+            s += " - Enter this number in the form";
+        });
+    }
+
+    const LabelCache &labels() const { return cache; }
+
+private:
+    enum Kind : unsigned
+    {
+        UNIT_TAG,
+        SCENE_TIMER,
+        UNIT_TITLE,
+        UNIT_DETAIL,
+        UNIT_PATIENT,
+        HOSPITAL_TITLE,
+        QUEUE_ITEM,
+        QUEUE_MORE,
+        TOTALS,
+        FLEET_STATUS,
+        SIM_CLOCK,
+        SECONDS_AGO,
+        HOUSE_HINT
+    };
+
+    LabelCache cache;
+};
@@ -0,0 +1,187 @@
+// Synthetic emergency calls for load testing, in three arrival patterns:
+//   POISSON        independent calls at a constant mean rate
+//   BURSTY         the rate switches between calm and surge periods of
+//                  random length (a two-state Markov-modulated Poisson process)
+//   MASS_CASUALTY  Poisson background plus incidents that put many critical
+//                  calls from houses around one spot within a short window
+// Calls come out in time order and depend only on the seed and the city.
+
+#pragma once
+
+#include "simulation.h"
+
+#include <cstring>
+#include <queue>
+#include <random>
+
+enum class ArrivalPattern : unsigned char
+{
+    POISSON,
+    BURSTY,
+    MASS_CASUALTY
+};
+
+inline const char *arrivalPatternName(ArrivalPattern p)
+{
+    return p == ArrivalPattern::POISSON ? "poisson" : p == ArrivalPattern::BURSTY ? "bursty" : "mass";
+}
+
+inline bool parseArrivalPattern(const char *s, ArrivalPattern &out)
+{
+    if (!strcmp(s, "poisson"))
+        out = ArrivalPattern::POISSON;
+    else if (!strcmp(s, "bursty"))
+        out = ArrivalPattern::BURSTY;
+    else if (!strcmp(s, "mass"))
+        out = ArrivalPattern::MASS_CASUALTY;
+    else
+        return false;
+    return true;
+}
+
+struct LoadConfig
+{
+    ArrivalPattern pattern = ArrivalPattern::POISSON;
+    double rate = 1.0; // mean calls per sim second (calm rate when BURSTY)
+    unsigned seed = 1;
+
+    // BURSTY
+    double surgeFactor = 8.0;  // rate multiplier during a surge
+    double calmSeconds = 120.0; // mean length of a calm period
+    double surgeSeconds = 15.0; // mean length of a surge
+
+    // MASS_CASUALTY
+    double incidentEvery = 180.0; // mean sim seconds between incidents
+    int casualties = 40;          // calls per incident
+    float incidentRadius = 150.0f;
+    double incidentSpread = 20.0; // the calls of one incident arrive within this many seconds
+};
+
+class LoadGenerator
+{
+public:
+    LoadGenerator(const CityMap &cityMap, const LoadConfig &config)
+        : city(cityMap), cfg(config), rng(config.seed), pickHouse(0, max(0, (int)cityMap.houses.size() - 1))
+    {
+        nextBackground = interArrival(cfg.rate);
+        if (cfg.pattern == ArrivalPattern::BURSTY)
+            stateEnds = exponential(cfg.calmSeconds);
+        if (cfg.pattern == ArrivalPattern::MASS_CASUALTY)
+            nextIncident = exponential(cfg.incidentEvery);
+    }
+
+    // Calls every call due at or before sim time t, in time order, as
+    // emit(const Emergency &) with createdAt set to the arrival time.
+    template <typename F>
+    int poll(double t, F &&emit)
+    {
+        int n = 0;
+        if (city.houses.empty())
+            return n;
+        for (;;)
+        {
+            if (cfg.pattern == ArrivalPattern::MASS_CASUALTY && nextIncident <= t && nextIncident <= nextBackground)
+            {
+                scheduleIncident(nextIncident);
+                nextIncident += exponential(cfg.incidentEvery);
+                continue;
+            }
+            double due = nextBackground;
+            bool incidentCall = !incident.empty() && incident.top().createdAt <= due;
+            if (incidentCall)
+                due = incident.top().createdAt;
+            if (due > t)
+                return n;
+            if (incidentCall)
+            {
+                emit(incident.top());
+                incident.pop();
+            }
+            else
+            {
+                Emergency e = call(houseIndex(), due, randomPriority());
+                advanceBackground();
+                emit(e);
+            }
+            n++;
+        }
+    }
+
+    // Current calls per sim second of the background process.
+    double currentRate() const { return surging ? cfg.rate * cfg.surgeFactor : cfg.rate; }
+
+private:
+    const CityMap &city;
+    LoadConfig cfg;
+    mt19937 rng;
+    uniform_int_distribution<int> pickHouse;
+    double nextBackground = 0.0;
+    bool surging = false;
+    double stateEnds = 0.0;
+    double nextIncident = numeric_limits<double>::infinity();
+    int callCount = 0;
+
+    struct LaterFirst
+    {
+        bool operator()(const Emergency &a, const Emergency &b) const { return a.createdAt > b.createdAt; }
+    };
+    priority_queue<Emergency, vector<Emergency>, LaterFirst> incident; // scheduled incident calls
+
+    double exponential(double mean) { return exponential_distribution<double>(1.0 / mean)(rng); }
+    double interArrival(double rate) { return rate > 0 ? exponential_distribution<double>(rate)(rng) : numeric_limits<double>::infinity(); }
+    int houseIndex() { return pickHouse(rng); }
+    int randomPriority() { return uniform_int_distribution<int>(1, 3)(rng); }
+
+    // Next background arrival. Under BURSTY, a gap that runs past the end of
+    // the current period is redrawn from there at the new rate, which is
+    // exact for exponential gaps.
+    void advanceBackground()
+    {
+        double from = nextBackground;
+        for (;;)
+        {
+            double next = from + interArrival(currentRate());
+            if (cfg.pattern != ArrivalPattern::BURSTY || next <= stateEnds)
+            {
+                nextBackground = next;
+                return;
+            }
+            from = stateEnds;
+            surging = !surging;
+            stateEnds += exponential(surging ? cfg.surgeSeconds : cfg.calmSeconds);
+        }
+    }
+
+    // Casualties from houses around a random one, mostly critical.
+    void scheduleIncident(double at)
+    {
+        const House &centre = city.houses[houseIndex()];
+        Vec2 c = centre.frontDoor();
+        uniform_real_distribution<float> offset(-cfg.incidentRadius, cfg.incidentRadius);
+        uniform_real_distribution<double> delay(0.0, cfg.incidentSpread);
+        for (int i = 0; i < cfg.casualties; ++i)
+        {
+            int h = -1;
+            for (int tries = 0; tries < 8 && h < 0; ++tries)
+                h = city.houseAt(Vec2{c.x + offset(rng), c.y + offset(rng)});
+            if (h < 0)
+                h = (int)(&centre - city.houses.data());
+            int priority = uniform_int_distribution<int>(0, 9)(rng) < 7 ? 1 : 2;
+            incident.push(call(h, at + delay(rng), priority));
+        }
+    }
+
+    Emergency call(int house, double at, int priority)
+    {
+        static const char *severities[] = {"Critical", "High", "Normal"};
+        const House &h = city.houses[house];
+        Emergency e;
+        e.priority = priority;
+        e.createdAt = at;
+        e.patient.name = "L" + to_string(++callCount);
+        e.patient.severity = severities[priority - 1];
+        e.patient.houseNumber = h.id;
+        e.location = h.frontDoor();
+        return e;
+    }
+};
@@ -0,0 +1,384 @@
+// Synthetic load benchmark: drives the dispatcher with generated calls
+// (see load_gen.h) and reports intake throughput, step cost, dispatch
+// latency, response times and queue depth over time.
+// Build: make loadgen   (or g++ -std=c++17 -O2 loadgen.cpp -o loadgen -pthread)
+//
+// Usage: loadgen [--pattern poisson|bursty|mass] [--rate CALLS_PER_SIM_SECOND]
+//                [--duration SIM_SECONDS] [--seed S] [--blocks N] [--hospitals N]
+//                [--units PER_HOSPITAL] [--dispatch greedy|batch] [--city SPEC]
+//                [--load-city FILE] [--sample SIM_SECONDS] [--json FILE]
+//        bursty: [--surge FACTOR] [--calm SECONDS] [--surge-length SECONDS]
+//        mass:   [--incident-every SECONDS] [--casualties N]
+//
+// Per-call timings come from an in-memory event log of the run: dispatch
+// latency is intake to unit assigned, response time is intake to unit on
+// scene, both in simulated seconds. Wall-clock figures include the logging.
+// Intake throughput times generating and submitting calls alone; the end to
+// end figure (callsPerSecond in the JSON) includes stepping the simulation.
+
+#include "city_file.h"
+#include "city_gen.h"
+#include "load_gen.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+using namespace std;
+
+struct LoadOptions
+{
+    LoadConfig load;
+    double duration = 600.0;
+    float dt = 1.0f / 120.0f;
+    int blocks = 20;
+    int hospitals = 16;
+    int units = 6;
+    DispatchMode dispatch = DispatchMode::GREEDY;
+    double sample = 5.0;
+    string city, loadCity, json;
+};
+
+static bool parseOptions(int argc, char **argv, LoadOptions &o)
+{
+    bool ok = true;
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const char *k = argv[i], *v = argv[i + 1];
+        if (!strcmp(k, "--pattern"))
+        {
+            if (!parseArrivalPattern(v, o.load.pattern))
+            {
+                fprintf(stderr, "--pattern is poisson, bursty or mass\n");
+                ok = false;
+            }
+        }
+        else if (!strcmp(k, "--rate"))
+            o.load.rate = atof(v);
+        else if (!strcmp(k, "--duration"))
+            o.duration = atof(v);
+        else if (!strcmp(k, "--seed"))
+            o.load.seed = (unsigned)strtoul(v, nullptr, 10);
+        else if (!strcmp(k, "--blocks"))
+            o.blocks = atoi(v);
+        else if (!strcmp(k, "--hospitals"))
+            o.hospitals = atoi(v);
+        else if (!strcmp(k, "--units"))
+            o.units = atoi(v);
+        else if (!strcmp(k, "--dispatch"))
+        {
+            if (!parseDispatchMode(v, o.dispatch))
+            {
+                fprintf(stderr, "--dispatch is greedy or batch\n");
+                ok = false;
+            }
+        }
+        else if (!strcmp(k, "--city"))
+            o.city = v;
+        else if (!strcmp(k, "--load-city"))
+            o.loadCity = v;
+        else if (!strcmp(k, "--sample"))
+            o.sample = max(atof(v), 0.1);
+        else if (!strcmp(k, "--json"))
+            o.json = v;
+        else if (!strcmp(k, "--surge"))
+            o.load.surgeFactor = atof(v);
+        else if (!strcmp(k, "--calm"))
+            o.load.calmSeconds = atof(v);
+        else if (!strcmp(k, "--surge-length"))
+            o.load.surgeSeconds = atof(v);
+        else if (!strcmp(k, "--incident-every"))
+            o.load.incidentEvery = atof(v);
+        else if (!strcmp(k, "--casualties"))
+            o.load.casualties = atoi(v);
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", k);
+            ok = false;
+        }
+    }
+    if (o.blocks < 1 || o.hospitals < 1 || o.units < 1)
+    {
+        fprintf(stderr, "--blocks, --hospitals and --units must be at least 1\n");
+        ok = false;
+    }
+    if (!(o.load.calmSeconds > 0) || !(o.load.surgeSeconds > 0) || !(o.load.incidentEvery > 0))
+    {
+        fprintf(stderr, "--calm, --surge-length and --incident-every must be more than 0\n");
+        ok = false;
+    }
+    return ok;
+}
+
+// ----------------------------- Statistics ---------------------------------
+
+// Nearest-rank percentiles of a sample, sorted on construction.
+struct Distribution
+{
+    vector<double> v;
+    double sum = 0.0;
+
+    explicit Distribution(vector<double> values) : v(move(values))
+    {
+        sort(v.begin(), v.end());
+        for (double x : v)
+            sum += x;
+    }
+    size_t count() const { return v.size(); }
+    double mean() const { return v.empty() ? 0.0 : sum / v.size(); }
+    double max() const { return v.empty() ? 0.0 : v.back(); }
+    double percentile(double p) const
+    {
+        if (v.empty())
+            return 0.0;
+        size_t rank = (size_t)ceil(p / 100.0 * v.size());
+        return v[rank ? rank - 1 : 0];
+    }
+};
+
+// Per-call times in sim seconds, recovered from the event log of the run.
+struct CallTimes
+{
+    vector<double> dispatch, response;
+    vector<double> responseByPriority[3];
+};
+
+static CallTimes callTimes(const EventLog &log, SimMicros stepMicros)
+{
+    struct Call
+    {
+        long long intake = -1, assigned = -1, onScene = -1;
+        int priority = 3;
+    };
+    vector<Call> calls;
+    map<pair<int, int>, int> byLocalId; // (hospital, hospital-local id) -> call
+    map<pair<int, int>, int> byUnit;    // (hospital, ambulance id) -> call it is serving
+    EventLogReader reader(log.bytes());
+    LogRecord r;
+    while (reader.next(r))
+    {
+        switch (r.tag)
+        {
+        case EventLog::INTAKE:
+            calls.push_back({r.tick, -1, -1, r.emergency.priority});
+            break;
+        case EventLog::ROUTED:
+            byLocalId[{r.hospital, r.id}] = (int)calls.size() - 1;
+            break;
+        case EventLog::LEND:
+        {
+            auto it = byLocalId.find({r.hospital, r.id});
+            if (it != byLocalId.end())
+                byLocalId[{r.toHospital, r.toId}] = it->second;
+            break;
+        }
+        case EventLog::ASSIGN:
+        {
+            auto it = byLocalId.find({r.hospital, r.id});
+            if (it == byLocalId.end())
+                break;
+            calls[it->second].assigned = r.tick;
+            byUnit[{r.hospital, r.ambulanceId}] = it->second;
+            break;
+        }
+        case EventLog::STATUS:
+        {
+            auto it = byUnit.find({r.hospital, r.ambulanceId});
+            if (r.status == Ambulance::Status::ON_SCENE && it != byUnit.end())
+            {
+                calls[it->second].onScene = r.tick;
+                byUnit.erase(it);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    CallTimes t;
+    for (auto &c : calls)
+    {
+        if (c.assigned >= 0)
+            t.dispatch.push_back(toSeconds((c.assigned - c.intake) * stepMicros));
+        if (c.onScene >= 0)
+        {
+            double s = toSeconds((c.onScene - c.intake) * stepMicros);
+            t.response.push_back(s);
+            t.responseByPriority[clamp(c.priority, 1, 3) - 1].push_back(s);
+        }
+    }
+    return t;
+}
+
+struct DepthSample
+{
+    double time;
+    int pending, busy;
+};
+
+// ----------------------------- Output -------------------------------------
+
+static void printDistribution(const char *name, const Distribution &d, const char *unit, double scale)
+{
+    printf("%-13s n=%-8zu mean %8.2f  p50 %8.2f  p90 %8.2f  p99 %8.2f  max %8.2f %s\n", name, d.count(), d.mean() * scale,
+           d.percentile(50) * scale, d.percentile(90) * scale, d.percentile(99) * scale, d.max() * scale, unit);
+}
+
+static void jsonDistribution(FILE *f, const char *name, const Distribution &d, double scale, bool last = false)
+{
+    fprintf(f, "    \"%s\": {\"count\": %zu, \"mean\": %.6g, \"p50\": %.6g, \"p90\": %.6g, \"p99\": %.6g, \"max\": %.6g}%s\n",
+            name, d.count(), d.mean() * scale, d.percentile(50) * scale, d.percentile(90) * scale, d.percentile(99) * scale,
+            d.max() * scale, last ? "" : ",");
+}
+
+int main(int argc, char **argv)
+{
+    LoadOptions opt;
+    if (!parseOptions(argc, argv, opt))
+        return 1;
+
+    CitySpec spec;
+    spec.cfg.seed = opt.load.seed;
+    spec.cfg.blocksX = spec.cfg.blocksY = opt.blocks;
+    spec.hospitals = opt.hospitals;
+    spec.units = opt.units;
+    string error;
+    if (!opt.city.empty() && !loadCitySpec(opt.city, spec, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    CityMap city;
+    vector<HospitalSite> sites;
+    if (opt.loadCity.empty())
+        city = buildCity(spec.cfg, spec.threads);
+    else if (!loadCityFile(opt.loadCity, city, sites, error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    Simulation sim(move(city), opt.dt);
+    sim.setDispatchMode(opt.dispatch);
+    if (!opt.loadCity.empty())
+        addHospitals(sim, sites);
+    else
+        placeHospitalGrid(sim, spec.hospitals, spec.units);
+    if (sim.getHospitals().empty())
+    {
+        fprintf(stderr, "no hospitals to take calls: --hospitals must be at least 1\n");
+        return 1;
+    }
+    EventLog log;
+    sim.attachLog(&log);
+    int fleet = 0;
+    for (auto &h : sim.getHospitals())
+        fleet += h.fleetSize();
+
+    LoadGenerator gen(sim.map(), opt.load);
+    long long ticks = sim.tickAt(opt.duration);
+    vector<double> stepWall;
+    stepWall.reserve((size_t)ticks);
+    vector<DepthSample> depth;
+    double nextSample = 0.0;
+    int calls = 0;
+    double intakeWall = 0.0; // generating and submitting calls, apart from stepping
+    auto t0 = chrono::steady_clock::now();
+    for (long long t = 0; t < ticks; ++t)
+    {
+        auto i0 = chrono::steady_clock::now();
+        calls += gen.poll(sim.time(), [&](const Emergency &e) { sim.submit(e); });
+        auto s0 = chrono::steady_clock::now();
+        sim.step();
+        stepWall.push_back(chrono::duration<double>(chrono::steady_clock::now() - s0).count());
+        intakeWall += chrono::duration<double>(s0 - i0).count();
+        if (sim.time() >= nextSample)
+        {
+            int pending = 0, busy = 0;
+            for (auto &h : sim.getHospitals())
+            {
+                pending += h.pendingCount();
+                busy += h.fleetSize() - h.idleCount();
+            }
+            depth.push_back({sim.time(), pending, busy});
+            nextSample += opt.sample;
+        }
+    }
+    double wall = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    sim.closeLog();
+
+    CallTimes times = callTimes(log, sim.fixedStepMicros());
+    Distribution step(move(stepWall)), dispatch(times.dispatch), response(times.response);
+    int handled = 0, pending = 0;
+    for (auto &h : sim.getHospitals())
+    {
+        handled += h.handled();
+        pending += h.pendingCount();
+    }
+    int maxDepth = 0;
+    double meanDepth = 0.0;
+    for (auto &d : depth)
+    {
+        maxDepth = max(maxDepth, d.pending);
+        meanDepth += d.pending;
+    }
+    meanDepth = depth.empty() ? 0.0 : meanDepth / depth.size();
+
+    printf("load         %s, %.2f calls/s, %.0f sim s, %d hospitals, %d units, %zu houses\n",
+           arrivalPatternName(opt.load.pattern), opt.load.rate, sim.time(), (int)sim.getHospitals().size(), fleet,
+           sim.map().houses.size());
+    printf("calls        %d (handled %d, pending %d, lent %d)\n", calls, handled, pending, sim.getNetwork().lentCount());
+    printf("intake       %.0f calls/s wall (generate and submit only, %.3f s)\n",
+           intakeWall > 0 ? calls / intakeWall : 0.0, intakeWall);
+    printf("end to end   %.0f calls/s wall with stepping, %.0f ticks/s, %.1fx real time\n", wall > 0 ? calls / wall : 0.0,
+           wall > 0 ? ticks / wall : 0.0, wall > 0 ? sim.time() / wall : 0.0);
+    printDistribution("step", step, "us", 1e6);
+    printDistribution("dispatch", dispatch, "s", 1.0);
+    printDistribution("response", response, "s", 1.0);
+    for (int p = 0; p < 3; ++p)
+    {
+        char name[32];
+        snprintf(name, sizeof name, "  priority %d", p + 1);
+        printDistribution(name, Distribution(times.responseByPriority[p]), "s", 1.0);
+    }
+    printf("queue depth  mean %.1f, max %d waiting calls (%zu samples)\n", meanDepth, maxDepth, depth.size());
+
+    if (opt.json.empty())
+        return 0;
+    FILE *f = fopen(opt.json.c_str(), "w");
+    if (!f)
+    {
+        fprintf(stderr, "cannot write %s\n", opt.json.c_str());
+        return 1;
+    }
+    fprintf(f, "{\n  \"config\": {\"pattern\": \"%s\", \"rate\": %g, \"duration\": %g, \"seed\": %u, \"dt\": %g, "
+               "\"hospitals\": %d, \"units\": %d, \"houses\": %zu, \"dispatch\": \"%s\"},\n",
+            arrivalPatternName(opt.load.pattern), opt.load.rate, opt.duration, opt.load.seed, opt.dt,
+            (int)sim.getHospitals().size(), fleet, sim.map().houses.size(),
+            opt.dispatch == DispatchMode::BATCH ? "batch" : "greedy");
+    fprintf(f, "  \"calls\": {\"submitted\": %d, \"handled\": %d, \"pending\": %d, \"lent\": %d},\n", calls, handled,
+            pending, sim.getNetwork().lentCount());
+    fprintf(f, "  \"throughput\": {\"wallSeconds\": %.6g, \"callsPerSecond\": %.6g, \"ticksPerSecond\": %.6g, "
+               "\"intakeWallSeconds\": %.6g, \"intakeCallsPerSecond\": %.6g},\n",
+            wall, wall > 0 ? calls / wall : 0.0, wall > 0 ? ticks / wall : 0.0, intakeWall,
+            intakeWall > 0 ? calls / intakeWall : 0.0);
+    fprintf(f, "  \"latency\": {\n");
+    jsonDistribution(f, "stepMicros", step, 1e6);
+    jsonDistribution(f, "dispatchSeconds", dispatch, 1.0);
+    jsonDistribution(f, "responseSeconds", response, 1.0);
+    for (int p = 0; p < 3; ++p)
+    {
+        char name[32];
+        snprintf(name, sizeof name, "responseSecondsPriority%d", p + 1);
+        jsonDistribution(f, name, Distribution(times.responseByPriority[p]), 1.0, p == 2);
+    }
+    fprintf(f, "  },\n  \"queueDepth\": [");
+    for (size_t i = 0; i < depth.size(); ++i)
+        fprintf(f, "%s\n    {\"time\": %.3f, \"pending\": %d, \"busy\": %d}", i ? "," : "", depth[i].time, depth[i].pending,
+                depth[i].busy);
+    fprintf(f, "\n  ]\n}\n");
+    fclose(f);
+    return 0;
+}
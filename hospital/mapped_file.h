@@ -0,0 +1,121 @@
+// Read-only file mapped into memory, and the atomic replace the writers of
+// the flat file formats (city_file.h, distance_table.h) and metrics.h use.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+#ifdef _WIN32
+// The few kernel32 calls needed, declared here because <windows.h> clashes
+// with raylib.h (CloseWindow, DrawText, Rectangle) in main.cpp.
+extern "C"
+{
+    __declspec(dllimport) void *__stdcall CreateFileA(const char *, unsigned long, unsigned long, void *, unsigned long, unsigned long, void *);
+    __declspec(dllimport) int __stdcall GetFileSizeEx(void *, long long *);
+    __declspec(dllimport) void *__stdcall CreateFileMappingA(void *, void *, unsigned long, unsigned long, unsigned long, const char *);
+    __declspec(dllimport) void *__stdcall MapViewOfFile(void *, unsigned long, unsigned long, unsigned long, size_t);
+    __declspec(dllimport) int __stdcall UnmapViewOfFile(const void *);
+    __declspec(dllimport) int __stdcall CloseHandle(void *);
+    __declspec(dllimport) int __stdcall MoveFileExA(const char *, const char *, unsigned long);
+}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Moves the finished file `tmp` over `path` in one step: a reader opening
+// `path` meanwhile finds the old file or the new one, never neither. On
+// failure both files are left as they were.
+inline bool replaceFile(const string &tmp, const string &path)
+{
+#ifdef _WIN32
+    const unsigned long replaceExisting = 0x1; // rename() does not replace on Windows
+    return MoveFileExA(tmp.c_str(), path.c_str(), replaceExisting) != 0;
+#else
+    return rename(tmp.c_str(), path.c_str()) == 0;
+#endif
+}
+
+// Read-only file mapped copy-on-write. Keeps the mapping until destroyed.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const string &path, string &error)
+    {
+        close();
+#ifdef _WIN32
+        const unsigned long genericRead = 0x80000000ul, shareRead = 1, openExisting = 3, normal = 0x80;
+        const unsigned long pageWriteCopy = 0x08, fileMapCopy = 0x01;
+        void *file = CreateFileA(path.c_str(), genericRead, shareRead, nullptr, openExisting, normal, nullptr);
+        if (file == (void *)-1) // INVALID_HANDLE_VALUE
+        {
+            error = "cannot open " + path;
+            return false;
+        }
+        long long size = 0;
+        if (GetFileSizeEx(file, &size))
+            bytes = (size_t)size;
+        void *mapping = bytes ? CreateFileMappingA(file, nullptr, pageWriteCopy, 0, 0, nullptr) : nullptr;
+        CloseHandle(file);
+        if (mapping)
+        {
+            base = MapViewOfFile(mapping, fileMapCopy, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            error = "cannot open " + path;
+            return false;
+        }
+        struct stat st;
+        if (fstat(fd, &st) == 0)
+            bytes = (size_t)st.st_size;
+        if (bytes)
+        {
+            void *p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            base = p == MAP_FAILED ? nullptr : p;
+        }
+        ::close(fd);
+#endif
+        if (!base)
+        {
+            error = "cannot map " + path;
+            bytes = 0;
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        if (!base)
+            return;
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+#else
+        munmap(base, bytes);
+#endif
+        base = nullptr;
+        bytes = 0;
+    }
+
+    unsigned char *data() const { return (unsigned char *)base; }
+    size_t size() const { return bytes; }
+
+private:
+    void *base = nullptr;
+    size_t bytes = 0;
+};
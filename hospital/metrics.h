@@ -0,0 +1,329 @@
+// Runtime metrics: counters, gauges and latency histograms, registered by
+// name (and optional Prometheus labels) in a MetricsRegistry. Hot paths keep
+// the reference registration returns and update it without locks:
+//   Counter    sharded per thread; add() is one relaxed fetch_add on the
+//              calling thread's own cache line
+//   Gauge      last value set
+//   Histogram  log-linear buckets as in HdrHistogram: every power of two is
+//              split into 2^subBits linear sub-buckets, so any recorded value
+//              is known to within 1/32 of itself. Also sharded per thread;
+//              shards and snapshots merge by adding bucket arrays.
+// The registry renders a snapshot in the Prometheus text format, to a
+// string or a file; metrics_server.h serves it over HTTP on localhost.
+
+#pragma once
+
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace metrics
+{
+static const int shards = 8; // threads beyond this share shards
+
+// Shard of the calling thread, handed out round-robin on first use.
+inline int shardIndex()
+{
+    static atomic<int> next{0};
+    static thread_local int shard = next.fetch_add(1, memory_order_relaxed) % shards;
+    return shard;
+}
+}
+
+// ----------------------------- Counter ------------------------------------
+
+class Counter
+{
+public:
+    void add(uint64_t n = 1) { cells[metrics::shardIndex()].value.fetch_add(n, memory_order_relaxed); }
+
+    uint64_t value() const
+    {
+        uint64_t sum = 0;
+        for (auto &c : cells)
+            sum += c.value.load(memory_order_relaxed);
+        return sum;
+    }
+
+private:
+    struct alignas(64) Cell
+    {
+        atomic<uint64_t> value{0};
+    };
+    Cell cells[metrics::shards];
+};
+
+// ----------------------------- Gauge --------------------------------------
+
+class Gauge
+{
+public:
+    void set(double v) { current.store(v, memory_order_relaxed); }
+    double value() const { return current.load(memory_order_relaxed); }
+
+private:
+    atomic<double> current{0.0};
+};
+
+// ----------------------------- Histogram ----------------------------------
+
+// Bucket counts of one histogram at one moment, or the merge of several.
+struct HistogramSnapshot
+{
+    vector<uint64_t> counts; // Histogram::bucketCount entries
+    uint64_t count = 0, sum = 0;
+
+    void merge(const HistogramSnapshot &o)
+    {
+        if (counts.size() < o.counts.size())
+            counts.resize(o.counts.size(), 0);
+        for (size_t i = 0; i < o.counts.size(); ++i)
+            counts[i] += o.counts[i];
+        count += o.count;
+        sum += o.sum;
+    }
+
+    double mean() const { return count ? (double)sum / count : 0.0; }
+
+    // Value at quantile q (0..1): the midpoint of the bucket holding the
+    // ceil(q * count)-th smallest value.
+    double quantile(double q) const;
+};
+
+class Histogram
+{
+public:
+    static const int subBits = 5;  // 32 sub-buckets per power of two
+    static const int maxBits = 40; // larger values land in the last bucket
+    static const int subCount = 1 << subBits;
+    static const int bucketCount = (maxBits - subBits + 1) * subCount;
+
+    // Values below subCount have a bucket each; above, the bucket is the
+    // top subBits + 1 significant bits of the value.
+    static int bucketOf(uint64_t v)
+    {
+        if (v < (uint64_t)subCount)
+            return (int)v;
+        if (v >> maxBits)
+            return bucketCount - 1;
+        int e = 63 - __builtin_clzll(v);
+        return (e - subBits + 1) * subCount + (int)((v >> (e - subBits)) - subCount);
+    }
+    static uint64_t lowerBound(int bucket)
+    {
+        if (bucket < subCount)
+            return (uint64_t)bucket;
+        int e = bucket / subCount + subBits - 1;
+        return (uint64_t)(subCount + bucket % subCount) << (e - subBits);
+    }
+    static uint64_t bucketWidth(int bucket) { return bucket < subCount ? 1 : 1ull << (bucket / subCount - 1); }
+
+    void record(uint64_t v)
+    {
+        Shard &s = shard[metrics::shardIndex()];
+        s.counts[bucketOf(v)].fetch_add(1, memory_order_relaxed);
+        s.sum.fetch_add(v, memory_order_relaxed);
+    }
+
+    // Adds the current counts to `out`; shards a writer is updating may be
+    // one event ahead of their sum.
+    void snapshot(HistogramSnapshot &out) const
+    {
+        out.counts.resize(bucketCount, 0);
+        for (auto &s : shard)
+        {
+            for (int i = 0; i < bucketCount; ++i)
+            {
+                uint64_t c = s.counts[i].load(memory_order_relaxed);
+                out.counts[i] += c;
+                out.count += c;
+            }
+            out.sum += s.sum.load(memory_order_relaxed);
+        }
+    }
+
+private:
+    struct alignas(64) Shard
+    {
+        atomic<uint64_t> counts[bucketCount] = {};
+        atomic<uint64_t> sum{0};
+    };
+    Shard shard[metrics::shards];
+};
+
+inline double HistogramSnapshot::quantile(double q) const
+{
+    if (!count)
+        return 0.0;
+    uint64_t rank = max<uint64_t>(1, (uint64_t)ceil(q * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+            return Histogram::lowerBound((int)i) + (Histogram::bucketWidth((int)i) - 1) / 2.0;
+    }
+    return (double)Histogram::lowerBound((int)counts.size() - 1);
+}
+
+// ----------------------------- Registry -----------------------------------
+
+enum class MetricType : unsigned char
+{
+    COUNTER,
+    GAUGE,
+    HISTOGRAM
+};
+
+class MetricsRegistry
+{
+public:
+    // The metric called `name` with these labels (`priority="1"`), created
+    // on first use; later calls return the same one. `help` goes into the
+    // export. References stay valid for the registry's lifetime.
+    Counter &counter(const string &name, const string &help, const string &labels = "")
+    {
+        return *find(name, help, labels, MetricType::COUNTER, 1.0).counter;
+    }
+    Gauge &gauge(const string &name, const string &help, const string &labels = "")
+    {
+        return *find(name, help, labels, MetricType::GAUGE, 1.0).gauge;
+    }
+    // `unit` converts recorded values to exported ones: histograms record
+    // integers, 1e-6 exports microseconds as seconds.
+    Histogram &histogram(const string &name, const string &help, const string &labels = "", double unit = 1.0)
+    {
+        return *find(name, help, labels, MetricType::HISTOGRAM, unit).histogram;
+    }
+
+    // Snapshot of one histogram, merged over every label set of `name`
+    // when `labels` is null.
+    HistogramSnapshot histogramSnapshot(const string &name, const string *labels = nullptr) const
+    {
+        HistogramSnapshot s;
+        lock_guard<mutex> lock(guard);
+        for (auto &m : entries)
+            if (m->type == MetricType::HISTOGRAM && m->name == name && (!labels || m->labels == *labels))
+                m->histogram->snapshot(s);
+        return s;
+    }
+
+    // Prometheus text exposition format 0.0.4. Histogram buckets are
+    // reported at powers of two of the recorded unit.
+    string prometheusText() const
+    {
+        string out;
+        char line[256];
+        lock_guard<mutex> lock(guard);
+        vector<bool> done(entries.size(), false);
+        for (size_t i = 0; i < entries.size(); ++i)
+        {
+            if (done[i])
+                continue;
+            const Metric &first = *entries[i];
+            static const char *typeNames[] = {"counter", "gauge", "histogram"};
+            out += "# HELP " + first.name + " " + first.help + "\n";
+            out += "# TYPE " + first.name + " " + typeNames[(int)first.type] + "\n";
+            for (size_t j = i; j < entries.size(); ++j)
+            {
+                const Metric &m = *entries[j];
+                if (m.name != first.name)
+                    continue;
+                done[j] = true;
+                string braces = m.labels.empty() ? "" : "{" + m.labels + "}";
+                if (m.type == MetricType::COUNTER)
+                    snprintf(line, sizeof line, "%s%s %llu\n", m.name.c_str(), braces.c_str(),
+                             (unsigned long long)m.counter->value());
+                else if (m.type == MetricType::GAUGE)
+                    snprintf(line, sizeof line, "%s%s %.6g\n", m.name.c_str(), braces.c_str(), m.gauge->value());
+                if (m.type != MetricType::HISTOGRAM)
+                {
+                    out += line;
+                    continue;
+                }
+                HistogramSnapshot s;
+                m.histogram->snapshot(s);
+                string prefix = m.labels.empty() ? "" : m.labels + ",";
+                uint64_t below = 0;
+                int bucket = 0;
+                for (int e = 0; e <= Histogram::maxBits; ++e)
+                {
+                    uint64_t bound = 1ull << e;
+                    for (; bucket < Histogram::bucketCount && Histogram::lowerBound(bucket) < bound; ++bucket)
+                        below += s.counts[bucket];
+                    snprintf(line, sizeof line, "%s_bucket{%sle=\"%.6g\"} %llu\n", m.name.c_str(), prefix.c_str(),
+                             bound * m.unit, (unsigned long long)below);
+                    out += line;
+                }
+                snprintf(line, sizeof line, "%s_bucket{%sle=\"+Inf\"} %llu\n%s_sum%s %.6f\n%s_count%s %llu\n",
+                         m.name.c_str(), prefix.c_str(), (unsigned long long)s.count, m.name.c_str(), braces.c_str(),
+                         s.sum * m.unit, m.name.c_str(), braces.c_str(), (unsigned long long)s.count);
+                out += line;
+            }
+        }
+        return out;
+    }
+
+    // Writes prometheusText() next to `path` and renames it into place, so
+    // a reader (a node_exporter textfile collector) never sees half a file.
+    bool writeFile(const string &path, string &error) const
+    {
+        string text = prometheusText();
+        string tmp = path + ".tmp";
+        FILE *f = fopen(tmp.c_str(), "wb");
+        if (!f)
+        {
+            error = "cannot write " + tmp;
+            return false;
+        }
+        bool ok = fwrite(text.data(), 1, text.size(), f) == text.size();
+        ok = fclose(f) == 0 && ok;
+        if (!ok || !replaceFile(tmp, path))
+        {
+            remove(tmp.c_str());
+            error = "error writing " + path;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    struct Metric
+    {
+        string name, help, labels;
+        MetricType type;
+        double unit;
+        unique_ptr<Counter> counter;
+        unique_ptr<Gauge> gauge;
+        unique_ptr<Histogram> histogram;
+    };
+    mutable mutex guard;
+    vector<unique_ptr<Metric>> entries;
+
+    Metric &find(const string &name, const string &help, const string &labels, MetricType type, double unit)
+    {
+        lock_guard<mutex> lock(guard);
+        for (auto &m : entries)
+            if (m->name == name && m->labels == labels && m->type == type)
+                return *m;
+        entries.emplace_back(new Metric{name, help, labels, type, unit, nullptr, nullptr, nullptr});
+        Metric &m = *entries.back();
+        if (type == MetricType::COUNTER)
+            m.counter.reset(new Counter);
+        else if (type == MetricType::GAUGE)
+            m.gauge.reset(new Gauge);
+        else
+            m.histogram.reset(new Histogram);
+        return m;
+    }
+};
@@ -0,0 +1,138 @@
+// Serves a MetricsRegistry in the Prometheus text format on
+// http://127.0.0.1:PORT/metrics from a thread of its own. Loopback only:
+// anything that wants the numbers off the machine scrapes through a local
+// agent. One request per connection, which is all a scraper needs.
+// POSIX only; on Windows start() fails and MetricsRegistry::writeFile is
+// the way out.
+
+#pragma once
+
+#include "metrics.h"
+
+#include <cstring>
+#include <thread>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // macOS: SO_NOSIGPIPE is set on the socket instead
+#endif
+#endif
+
+class MetricsServer
+{
+public:
+    ~MetricsServer() { stop(); }
+
+    bool start(const MetricsRegistry &registry, int port, string &error)
+    {
+#ifdef _WIN32
+        (void)registry;
+        (void)port;
+        error = "the metrics endpoint is not available on Windows";
+        return false;
+#else
+        stop();
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            error = "cannot create a socket";
+            return false;
+        }
+        int yes = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof yes);
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons((uint16_t)port);
+        if (bind(fd, (sockaddr *)&addr, sizeof addr) != 0 || listen(fd, 8) != 0)
+        {
+            error = "cannot listen on 127.0.0.1:" + to_string(port);
+            close(fd);
+            fd = -1;
+            return false;
+        }
+        running = true;
+        worker = thread([this, &registry]() { serve(registry); });
+        return true;
+#endif
+    }
+
+    void stop()
+    {
+        running = false;
+        if (worker.joinable())
+            worker.join();
+#ifndef _WIN32
+        if (fd >= 0)
+            close(fd);
+        fd = -1;
+#endif
+    }
+
+    long long requests() const { return served.load(memory_order_relaxed); }
+
+private:
+    int fd = -1;
+    thread worker;
+    atomic<bool> running{false};
+    atomic<long long> served{0};
+
+#ifndef _WIN32
+    // Polls so stop() is noticed within a fraction of a second.
+    void serve(const MetricsRegistry &registry)
+    {
+        while (running.load(memory_order_relaxed))
+        {
+            pollfd p = {fd, POLLIN, 0};
+            if (poll(&p, 1, 200) <= 0)
+                continue;
+            int client = accept(fd, nullptr, nullptr);
+            if (client < 0)
+                continue;
+            timeval timeout = {1, 0}; // a silent client cannot hold the thread
+            setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+#ifdef SO_NOSIGPIPE
+            int yes = 1;
+            setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &yes, sizeof yes);
+#endif
+            char request[2048];
+            ssize_t n = recv(client, request, sizeof request - 1, 0);
+            if (n > 0)
+            {
+                request[n] = 0;
+                string body, status = "200 OK";
+                if (!strncmp(request, "GET /metrics", 12) || !strncmp(request, "GET / ", 6))
+                    body = registry.prometheusText();
+                else
+                {
+                    status = "404 Not Found";
+                    body = "try /metrics\n";
+                }
+                string reply = "HTTP/1.1 " + status +
+                               "\r\nContent-Type: text/plain; version=0.0.4\r\nConnection: close\r\nContent-Length: " +
+                               to_string(body.size()) + "\r\n\r\n" + body;
+                sendAll(client, reply);
+                served.fetch_add(1, memory_order_relaxed);
+            }
+            close(client);
+        }
+    }
+
+    static void sendAll(int client, const string &data)
+    {
+        size_t at = 0;
+        while (at < data.size())
+        {
+            ssize_t n = send(client, data.data() + at, data.size() - at, MSG_NOSIGNAL);
+            if (n <= 0)
+                return;
+            at += (size_t)n;
+        }
+    }
+#endif
+};
@@ -0,0 +1,388 @@
+// Scoped-zone profiler. PROFILE_ZONE("name") times the rest of the enclosing
+// scope; each thread appends its zone events (start and end in CPU ticks,
+// zone id) to its own ring buffer without locks. One thread, the GUI loop
+// or a headless driver, calls Profiler::collect() regularly. collect() drains
+// every thread's ring into rolling per-zone statistics and, while a trace is
+// being recorded, into a buffer that stopTrace() writes out as Chrome
+// trace-event JSON (chrome://tracing, ui.perfetto.dev).
+//
+// Zones record only while Profiler::enable(true) is in effect; otherwise
+// each zone costs one flag check. Timestamps come from RDTSC on x86 and
+// steady_clock elsewhere. A recording zone costs two timestamp reads and
+// four relaxed stores. Back-to-back stages (profiler::Sequence) share their
+// boundary timestamps. "bench profiler" measures both. Build with
+// -DNO_PROFILER to compile every zone away.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#define PROFILER_RDTSC 1
+#endif
+
+using namespace std;
+
+namespace profiler
+{
+inline uint64_t now()
+{
+#ifdef PROFILER_RDTSC
+    return __rdtsc();
+#else
+    return (uint64_t)chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+// One thread's events. Only the owning thread writes; the collecting
+// thread reads behind it, and every field is atomic so the two never race.
+// The fields are relaxed atomics, which compile to plain loads and stores.
+// The collector checks the head again after reading: slots the writer
+// reused meanwhile are dropped.
+struct Ring
+{
+    static const uint32_t capacity = 1 << 15;
+    struct Slot
+    {
+        atomic<uint64_t> start{0}, end{0};
+        atomic<uint32_t> zone{0};
+    };
+
+    Slot slots[capacity];
+    atomic<uint64_t> head{0}; // events written so far
+    uint64_t tail = 0;        // collector: events consumed so far
+    int thread = 0;
+    char name[32] = {};
+
+    void push(uint32_t zone, uint64_t start, uint64_t end)
+    {
+        uint64_t h = head.load(memory_order_relaxed);
+        Slot &s = slots[h & (capacity - 1)];
+        s.start.store(start, memory_order_relaxed);
+        s.end.store(end, memory_order_relaxed);
+        s.zone.store(zone, memory_order_relaxed);
+        head.store(h + 1, memory_order_release);
+    }
+};
+}
+
+// Rolling figures of one zone, in microseconds.
+struct ZoneStats
+{
+    const char *name = "";
+    long long count = 0;     // events since the start
+    double totalMicros = 0;  // summed over every event
+    double p50 = 0, p99 = 0, max = 0; // over the last `window` events
+};
+
+class Profiler
+{
+public:
+    static const int maxZones = 64;
+    static const int window = 256; // samples behind the rolling percentiles
+
+    static Profiler &instance()
+    {
+        static Profiler p;
+        return p;
+    }
+
+    // Id of the zone called `name`, registering it on first use. Call sites
+    // cache the id (PROFILE_ZONE does), so this runs once per site.
+    uint32_t zone(const char *name)
+    {
+        lock_guard<mutex> lock(registry);
+        for (int i = 0; i < zoneCount; ++i)
+            if (!strcmp(zones[i].name, name))
+                return (uint32_t)i;
+        if (zoneCount == maxZones)
+            return maxZones - 1; // shares the last zone rather than failing
+        zones[zoneCount].name = name;
+        return (uint32_t)zoneCount++;
+    }
+
+    // Zones record only while enabled; off at start.
+    static void enable(bool on) { recording.store(on, memory_order_relaxed); }
+    static bool enabled() { return recording.load(memory_order_relaxed); }
+
+    // Ring of the calling thread, created on its first zone.
+    static profiler::Ring &threadRing()
+    {
+        static thread_local profiler::Ring *ring = nullptr;
+        if (!ring)
+            ring = instance().addRing();
+        return *ring;
+    }
+
+    // Label for the calling thread in traces ("sim", "gui").
+    void nameThread(const char *name)
+    {
+        profiler::Ring &r = threadRing();
+        snprintf(r.name, sizeof r.name, "%s", name);
+    }
+
+    // Drains every thread's events. From one thread only, often enough that
+    // no ring laps: a ring holds 32768 events.
+    void collect()
+    {
+        double perMicro = ticksPerMicro();
+        lock_guard<mutex> lock(registry);
+        for (auto &rp : rings)
+        {
+            profiler::Ring &r = *rp;
+            const uint64_t cap = profiler::Ring::capacity;
+            uint64_t head = r.head.load(memory_order_acquire);
+            uint64_t from = max(r.tail, head > cap ? head - cap : 0);
+            size_t first = pending.size();
+            for (uint64_t i = from; i < head; ++i)
+            {
+                const profiler::Ring::Slot &s = r.slots[i & (cap - 1)];
+                pending.push_back({s.start.load(memory_order_relaxed), s.end.load(memory_order_relaxed),
+                                   s.zone.load(memory_order_relaxed), r.thread});
+            }
+            // drop slots the writer reused while we copied, including the
+            // one it may be writing right now
+            uint64_t after = r.head.load(memory_order_acquire);
+            uint64_t safeFrom = after + 1 > cap ? after + 1 - cap : 0;
+            if (safeFrom > from)
+            {
+                size_t drop = (size_t)(min(safeFrom, head) - from);
+                pending.erase(pending.begin() + first, pending.begin() + first + drop);
+                lost += drop;
+            }
+            lost += from - r.tail;
+            r.tail = head;
+        }
+        for (auto &e : pending)
+        {
+            if (e.zone >= (uint32_t)zoneCount)
+                continue;
+            Zone &z = zones[e.zone];
+            float us = (float)((e.end - e.start) / perMicro);
+            z.samples[z.count % window] = us;
+            z.count++;
+            z.total += us;
+            z.dirty = true;
+            if (tracing && trace.size() < maxTraceEvents)
+                trace.push_back(e);
+        }
+        pending.clear();
+    }
+
+    // Zones seen so far, with their rolling percentiles. Same thread as collect().
+    const vector<ZoneStats> &stats()
+    {
+        lock_guard<mutex> lock(registry);
+        summary.resize(zoneCount);
+        for (int i = 0; i < zoneCount; ++i)
+        {
+            Zone &z = zones[i];
+            ZoneStats &s = summary[i];
+            s.name = z.name;
+            s.count = z.count;
+            s.totalMicros = z.total;
+            if (!z.dirty)
+                continue;
+            int n = (int)min<long long>(z.count, window);
+            float sorted[window];
+            copy(z.samples, z.samples + n, sorted);
+            sort(sorted, sorted + n);
+            s.p50 = sorted[(n - 1) / 2];
+            s.p99 = sorted[(n * 99 + 99) / 100 - 1];
+            s.max = sorted[n - 1];
+            z.dirty = false;
+        }
+        return summary;
+    }
+
+    // Events dropped because a ring lapped before collect().
+    long long lostEvents() const { return lost; }
+
+    void startTrace()
+    {
+        trace.clear();
+        traceBegin = profiler::now();
+        tracing = true;
+    }
+    bool isTracing() const { return tracing; }
+
+    // Writes the trace recorded since startTrace() and stops recording.
+    bool stopTrace(const string &path, string &error)
+    {
+        tracing = false;
+        FILE *f = fopen(path.c_str(), "w");
+        if (!f)
+        {
+            error = "cannot write " + path;
+            return false;
+        }
+        double perMicro = ticksPerMicro();
+        fprintf(f, "{\"traceEvents\":[\n");
+        {
+            lock_guard<mutex> lock(registry);
+            for (auto &rp : rings)
+                fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}},\n", rp->thread,
+                        rp->name[0] ? rp->name : "thread");
+        }
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            const Event &e = trace[i];
+            fprintf(f, "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n", zones[e.zone].name,
+                    e.thread, (double)(int64_t)(e.start - traceBegin) / perMicro, (e.end - e.start) / perMicro,
+                    i + 1 < trace.size() ? "," : "");
+        }
+        fprintf(f, "]}\n");
+        bool ok = !ferror(f);
+        ok = fclose(f) == 0 && ok;
+        if (!ok)
+            error = "error writing " + path;
+        trace.clear();
+        trace.shrink_to_fit();
+        return ok;
+    }
+
+    // Timestamp ticks per microsecond, measured against steady_clock since
+    // the profiler started.
+    double ticksPerMicro() const
+    {
+#ifdef PROFILER_RDTSC
+        using namespace chrono;
+        auto wall = steady_clock::now();
+        uint64_t ticks = profiler::now();
+        // too little time has passed to tell: wait a moment
+        while (duration<double, micro>(wall - wallStart).count() < 1000.0)
+        {
+            wall = steady_clock::now();
+            ticks = profiler::now();
+        }
+        return (ticks - tickStart) / duration<double, micro>(wall - wallStart).count();
+#else
+        return chrono::steady_clock::period::den / 1e6 / chrono::steady_clock::period::num;
+#endif
+    }
+
+private:
+    struct Zone
+    {
+        const char *name = "";
+        float samples[window] = {};
+        long long count = 0;
+        double total = 0;
+        bool dirty = false;
+    };
+    struct Event
+    {
+        uint64_t start, end;
+        uint32_t zone;
+        int thread;
+    };
+    static const size_t maxTraceEvents = 4 << 20;
+    static inline atomic<bool> recording{false};
+
+    mutex registry; // zone names and the ring list
+    Zone zones[maxZones];
+    int zoneCount = 0;
+    vector<unique_ptr<profiler::Ring>> rings; // rings outlive their threads
+    vector<Event> pending, trace;
+    vector<ZoneStats> summary;
+    long long lost = 0;
+    bool tracing = false;
+    uint64_t traceBegin = 0;
+    uint64_t tickStart = profiler::now();
+    chrono::steady_clock::time_point wallStart = chrono::steady_clock::now();
+
+    Profiler() = default;
+
+    profiler::Ring *addRing()
+    {
+        lock_guard<mutex> lock(registry);
+        rings.emplace_back(new profiler::Ring);
+        rings.back()->thread = (int)rings.size();
+        return rings.back().get();
+    }
+};
+
+namespace profiler
+{
+// Times its own lifetime as one event of `zone`.
+class Scope
+{
+public:
+    explicit Scope(uint32_t zone) : id(zone)
+    {
+        if (Profiler::enabled())
+        {
+            ring = &Profiler::threadRing();
+            start = now();
+        }
+    }
+    ~Scope()
+    {
+        if (ring)
+            ring->push(id, start, now());
+    }
+    Scope(const Scope &) = delete;
+    Scope &operator=(const Scope &) = delete;
+
+private:
+    Ring *ring = nullptr;
+    uint32_t id;
+    uint64_t start = 0;
+};
+
+// Back-to-back stages of one scope (the GUI frame): next() ends the
+// running stage and starts another, the destructor ends the last one.
+class Sequence
+{
+public:
+    Sequence() : ring(Profiler::enabled() ? &Profiler::threadRing() : nullptr) {}
+    ~Sequence() { next(none); }
+    Sequence(const Sequence &) = delete;
+    Sequence &operator=(const Sequence &) = delete;
+
+    void next(uint32_t zone)
+    {
+        if (!ring)
+            return;
+        uint64_t t = now();
+        if (id != none)
+            ring->push(id, start, t);
+        id = zone;
+        start = t;
+    }
+
+private:
+    static const uint32_t none = ~0u;
+    Ring *ring;
+    uint32_t id = none;
+    uint64_t start = 0;
+};
+}
+
+#define PROFILE_CONCAT2(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT2(a, b)
+
+#ifdef NO_PROFILER
+#define PROFILE_ID(name) 0u
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_NEXT(seq, name) ((void)0)
+#else
+// Id of a zone, looked up once per call site.
+#define PROFILE_ID(name) ([]() { static const uint32_t id = Profiler::instance().zone(name); return id; }())
+#define PROFILE_ZONE(name) profiler::Scope PROFILE_CONCAT(profileZone_, __LINE__)(PROFILE_ID(name))
+#define PROFILE_NEXT(seq, name) (seq).next(PROFILE_ID(name))
+#endif
@@ -0,0 +1,130 @@
+// Deterministic replay of an EventLog: rebuilds the recorded city and
+// hospitals, feeds the recorded emergencies back in at their original ticks
+// and steps the simulation as fast as it goes. The rerun records its own log;
+// it must come out byte-identical to the original, which covers every
+// routing, assignment and status decision as well as the state hashes.
+
+#pragma once
+
+#include "city_gen.h"
+
+struct ReplayResult
+{
+    bool ok = false;
+    long long ticks = 0;
+    int emergencies = 0;
+    int records = 0;
+    uint64_t hash = 0;         // state hash at the end of the rerun
+    uint64_t expectedHash = 0; // END hash in the original log, 0 without one
+    bool unclosed = false;     // no END record: session crashed or is still running
+    string error;              // first divergence or load problem
+};
+
+namespace replay_detail
+{
+inline const char *tagName(EventLog::Tag t)
+{
+    static const char *names[] = {"?", "CONFIG", "HOSPITAL", "TICK", "INTAKE", "ROUTED",
+                                  "ASSIGN", "STATUS", "LEND", "CHECKPOINT", "END"};
+    return t <= EventLog::END ? names[t] : "?";
+}
+
+// Describe the first record where the two logs differ.
+inline string firstDivergence(const vector<unsigned char> &expected, const vector<unsigned char> &actual)
+{
+    EventLogReader a(expected), b(actual);
+    LogRecord ra, rb;
+    for (int n = 0;; ++n)
+    {
+        bool ha = a.next(ra), hb = b.next(rb);
+        if (!ha && !hb)
+            return "logs differ outside any record";
+        if (!ha || !hb)
+            return ha ? "rerun stopped early before tick " + to_string(ra.tick)
+                      : "rerun logged extra " + string(tagName(rb.tag)) + " at tick " + to_string(rb.tick);
+        if (ra.tick != rb.tick || ra.size != rb.size ||
+            !equal(expected.begin() + ra.offset, expected.begin() + ra.offset + ra.size, actual.begin() + rb.offset))
+            return "record " + to_string(n) + " differs: expected " + tagName(ra.tag) + " at tick " + to_string(ra.tick) +
+                   ", rerun logged " + tagName(rb.tag) + " at tick " + to_string(rb.tick);
+    }
+}
+}
+
+inline ReplayResult replayLog(const vector<unsigned char> &original)
+{
+    ReplayResult res;
+    EventLogReader reader(original);
+    LogRecord r;
+    if (!reader.next(r) || r.tag != EventLog::CONFIG)
+    {
+        res.error = reader.ok() ? "log does not start with a CONFIG record" : reader.lastError();
+        return res;
+    }
+    Simulation sim(buildCity(r.city), r.fixedStep);
+    sim.setDispatchMode((DispatchMode)r.dispatchMode);
+    if (r.distanceTable)
+    {
+        auto table = openDistanceTable("", sim.map().graph, 0, res.error);
+        if (!table)
+            return res;
+        sim.setDistanceTable(table);
+    }
+    EventLog rerun;
+    sim.attachLog(&rerun);
+
+    // everything after the hospitals is driven by intake records; the last
+    // record tells how long the session ran
+    vector<LogRecord> intakes;
+    long long lastTick = 0;
+    size_t validEnd = 0;
+    bool hospitalsDone = false;
+    while (reader.next(r))
+    {
+        res.records++;
+        validEnd = r.offset + r.size;
+        lastTick = max(lastTick, r.tick);
+        if (r.tag == EventLog::HOSPITAL && !hospitalsDone)
+            sim.addHospital(r.location, r.parking, r.onSceneDuration);
+        else
+            hospitalsDone = true;
+        if (r.tag == EventLog::INTAKE)
+            intakes.push_back(r);
+        else if (r.tag == EventLog::END)
+            res.expectedHash = r.hash;
+    }
+    // a log cut off mid-record (the writer flushes in chunks) replays up to
+    // its last complete record
+    if (!reader.ok() && !reader.truncated())
+    {
+        res.error = reader.lastError();
+        return res;
+    }
+    res.unclosed = !res.expectedHash;
+
+    for (auto &in : intakes)
+    {
+        sim.runUntil(in.tick);
+        sim.submit(in.emergency, in.emergency.assignedHospital);
+    }
+    // an unclosed log may hold records of a step that started at lastTick
+    sim.runUntil(lastTick + (res.unclosed ? 1 : 0));
+    if (!res.unclosed)
+        sim.closeLog();
+
+    res.ticks = sim.ticks();
+    res.emergencies = sim.emergencyCount();
+    res.hash = sim.stateHash();
+    const vector<unsigned char> &got = rerun.bytes();
+    // an unclosed original only has to match the start of the rerun
+    bool same = res.unclosed ? got.size() >= validEnd && equal(original.begin(), original.begin() + validEnd, got.begin())
+                             : got == original;
+    if (!same)
+    {
+        res.error = replay_detail::firstDivergence(original, got);
+        return res;
+    }
+    res.ok = res.unclosed || res.hash == res.expectedHash;
+    if (!res.ok)
+        res.error = "final state hash differs";
+    return res;
+}
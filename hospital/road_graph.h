@@ -0,0 +1,288 @@
+// Road network as a compressed (CSR) adjacency graph with A* routing.
+// Nodes are road intersections, arcs are the road segments between
+// neighbouring intersections. Closed roads and one-way streets are honoured.
+// Roads are axis-aligned rectangles, so every arc is horizontal or vertical.
+
+#pragma once
+
+#include "flat_array.h"
+#include "sim_types.h"
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+class RoadGraph
+{
+public:
+    static constexpr float CLOSED = numeric_limits<float>::infinity();
+
+    RoadGraph() = default;
+    explicit RoadGraph(const FlatArray<Road> &roads) { build(roads); }
+
+    // Rebuild from the road rectangles. Every crossing of a horizontal and a
+    // vertical road becomes a node; consecutive nodes along a road are joined.
+    void build(const FlatArray<Road> &roads)
+    {
+        nodePos.clear();
+        rowStart.clear();
+        adjNode.clear();
+        adjCost.clear();
+
+        vector<int> hIdx, vIdx;
+        for (int i = 0; i < (int)roads.size(); ++i)
+            (roads[i].horizontal ? hIdx : vIdx).push_back(i);
+
+        // node id of crossing (h, v), -1 if the roads do not meet
+        vector<int> cross(hIdx.size() * vIdx.size(), -1);
+        for (size_t a = 0; a < hIdx.size(); ++a)
+        {
+            const Rect &h = roads[hIdx[a]].rect;
+            float cy = h.y + h.height / 2.0f;
+            for (size_t b = 0; b < vIdx.size(); ++b)
+            {
+                const Rect &v = roads[vIdx[b]].rect;
+                float cx = v.x + v.width / 2.0f;
+                if (cx >= h.x && cx <= h.x + h.width && cy >= v.y && cy <= v.y + v.height)
+                {
+                    cross[a * vIdx.size() + b] = (int)nodePos.size();
+                    nodePos.push_back(Vec2{cx, cy});
+                }
+            }
+        }
+
+        struct Arc
+        {
+            int from, to;
+        };
+        vector<Arc> arcs;
+        vector<int> along;
+        auto link = [&](const Road &r)
+        {
+            if (r.closed)
+                return;
+            for (size_t k = 0; k + 1 < along.size(); ++k)
+            {
+                int a = along[k], b = along[k + 1];
+                if (r.oneWay >= 0)
+                    arcs.push_back({a, b});
+                if (r.oneWay <= 0)
+                    arcs.push_back({b, a});
+            }
+        };
+        for (size_t a = 0; a < hIdx.size(); ++a)
+        {
+            along.clear();
+            for (size_t b = 0; b < vIdx.size(); ++b)
+                if (cross[a * vIdx.size() + b] >= 0)
+                    along.push_back(cross[a * vIdx.size() + b]);
+            sort(along.begin(), along.end(), [&](int p, int q) { return nodePos[p].x < nodePos[q].x; });
+            link(roads[hIdx[a]]);
+        }
+        for (size_t b = 0; b < vIdx.size(); ++b)
+        {
+            along.clear();
+            for (size_t a = 0; a < hIdx.size(); ++a)
+                if (cross[a * vIdx.size() + b] >= 0)
+                    along.push_back(cross[a * vIdx.size() + b]);
+            sort(along.begin(), along.end(), [&](int p, int q) { return nodePos[p].y < nodePos[q].y; });
+            link(roads[vIdx[b]]);
+        }
+
+        // counting sort of arcs by source node into CSR rows
+        rowStart.assign(nodePos.size() + 1, 0);
+        for (auto &e : arcs)
+            rowStart[e.from + 1]++;
+        for (size_t i = 1; i < rowStart.size(); ++i)
+            rowStart[i] += rowStart[i - 1];
+        adjNode.resize(arcs.size());
+        adjCost.resize(arcs.size());
+        vector<int> fill(rowStart.begin(), rowStart.end() - 1);
+        for (auto &e : arcs)
+        {
+            int slot = fill[e.from]++;
+            adjNode[slot] = e.to;
+            adjCost[slot] = length(e.from, e.to);
+        }
+    }
+
+    int nodeCount() const { return (int)nodePos.size(); }
+    int arcCount() const { return (int)adjNode.size(); }
+    Vec2 position(int node) const { return nodePos[node]; }
+    const FlatArray<Vec2> &positions() const { return nodePos; }
+
+    // CSR accessors, arcs of node u are [arcBegin(u), arcEnd(u))
+    int arcBegin(int u) const { return rowStart[u]; }
+    int arcEnd(int u) const { return rowStart[u + 1]; }
+    int arcTarget(int arc) const { return adjNode[arc]; }
+    float arcCost(int arc) const { return adjCost[arc]; }
+
+    // Close or reopen the directed segment u -> v (e.g. an accident blocking one lane).
+    bool setArcClosed(int u, int v, bool closed)
+    {
+        for (int a = rowStart[u]; a < rowStart[u + 1]; ++a)
+            if (adjNode[a] == v)
+            {
+                adjCost[a] = closed ? CLOSED : length(u, v);
+                return true;
+            }
+        return false;
+    }
+
+    // A* from node s to node t. Fills outNodes with s..t and returns the road
+    // length, or returns -1 (outNodes empty) when t is unreachable.
+    float shortestPath(int s, int t, vector<int> &outNodes) const
+    {
+        outNodes.clear();
+        if (s < 0 || t < 0)
+            return -1.0f;
+        Scratch &sc = scratch();
+        sc.prepare(nodePos.size());
+        const uint32_t gen = sc.generation;
+        Vec2 goal = nodePos[t];
+        // every arc is axis-aligned, so Manhattan distance never overestimates
+        auto h = [&](int n)
+        { return fabsf(nodePos[n].x - goal.x) + fabsf(nodePos[n].y - goal.y); };
+
+        sc.open.clear();
+        sc.stamp[s] = gen;
+        sc.g[s] = 0.0f;
+        sc.parent[s] = -1;
+        sc.open.push_back({h(s), 0.0f, s});
+        while (!sc.open.empty())
+        {
+            pop_heap(sc.open.begin(), sc.open.end(), OpenGreater());
+            OpenEntry cur = sc.open.back();
+            sc.open.pop_back();
+            int u = cur.node;
+            if (sc.closed[u] == gen)
+                continue;
+            sc.closed[u] = gen;
+            if (u == t)
+                break;
+            float gu = sc.g[u];
+            for (int a = rowStart[u]; a < rowStart[u + 1]; ++a)
+            {
+                float c = adjCost[a];
+                if (c == CLOSED)
+                    continue;
+                int v = adjNode[a];
+                float gv = gu + c;
+                if (sc.stamp[v] != gen || gv < sc.g[v])
+                {
+                    sc.stamp[v] = gen;
+                    sc.g[v] = gv;
+                    sc.parent[v] = u;
+                    sc.open.push_back({gv + h(v), gv, v});
+                    push_heap(sc.open.begin(), sc.open.end(), OpenGreater());
+                }
+            }
+        }
+        if (sc.closed[t] != gen)
+            return -1.0f;
+        for (int n = t; n != -1; n = sc.parent[n])
+            outNodes.push_back(n);
+        reverse(outNodes.begin(), outNodes.end());
+        return sc.g[t];
+    }
+
+    // Driving route from intersection s to an arbitrary point `end` whose
+    // nearest intersection is t: the intersections along the shortest road
+    // path, then `end` itself. If t cannot be reached by road the route
+    // degenerates to a straight line so the unit still responds. Returns the
+    // route length, or -1 for the straight-line fallback.
+    float route(int s, int t, Vec2 end, vector<Vec2> &out) const
+    {
+        out.clear();
+        vector<int> &nodes = scratch().nodes;
+        float len = shortestPath(s, t, nodes);
+        if (len < 0.0f)
+        {
+            out.push_back(end);
+            return -1.0f;
+        }
+        for (int n : nodes)
+            out.push_back(nodePos[n]);
+        Vec2 last = nodePos[t];
+        out.push_back(end);
+        return len + sqrtf((end.x - last.x) * (end.x - last.x) + (end.y - last.y) * (end.y - last.y));
+    }
+
+    // Calls v.array / v.value on every stored member, always in the same
+    // order (city_file.h saves and maps the graph through this).
+    template <typename Self, typename V>
+    static void visitStorage(Self &g, V &v)
+    {
+        v.array("NPOS", g.nodePos);
+        v.array("ROWS", g.rowStart);
+        v.array("ADJN", g.adjNode);
+        v.array("ADJC", g.adjCost);
+    }
+
+    // Array sizes agree with each other (for storage that was not built here).
+    bool consistent() const
+    {
+        return rowStart.size() == nodePos.size() + 1 && (size_t)rowStart.back() == adjNode.size() &&
+               adjCost.size() == adjNode.size();
+    }
+
+private:
+    FlatArray<Vec2> nodePos;
+    FlatArray<int> rowStart;
+    FlatArray<int> adjNode;
+    FlatArray<float> adjCost;
+
+    struct OpenEntry
+    {
+        float f, g;
+        int node;
+    };
+    // min-heap on f; among equal f prefer the deeper node, which on grids
+    // stops the search from fanning out across every equally short route
+    struct OpenGreater
+    {
+        bool operator()(const OpenEntry &a, const OpenEntry &b) const { return a.f > b.f || (a.f == b.f && a.g < b.g); }
+    };
+
+    // Per-thread search state. Entries are valid only when their stamp equals
+    // the current generation, so nothing is cleared between queries.
+    struct Scratch
+    {
+        vector<float> g;
+        vector<int> parent;
+        vector<uint32_t> stamp, closed;
+        vector<OpenEntry> open;
+        vector<int> nodes;
+        uint32_t generation = 0;
+
+        void prepare(size_t n)
+        {
+            if (g.size() < n)
+            {
+                g.resize(n);
+                parent.resize(n);
+                stamp.resize(n, 0);
+                closed.resize(n, 0);
+            }
+            if (++generation == 0)
+            {
+                fill(stamp.begin(), stamp.end(), 0);
+                fill(closed.begin(), closed.end(), 0);
+                generation = 1;
+            }
+        }
+    };
+
+    static Scratch &scratch()
+    {
+        static thread_local Scratch s;
+        return s;
+    }
+
+    float length(int a, int b) const
+    {
+        float dx = nodePos[a].x - nodePos[b].x, dy = nodePos[a].y - nodePos[b].y;
+        return sqrtf(dx * dx + dy * dy);
+    }
+};
@@ -0,0 +1,211 @@
+// Nearest-intersection lookup. Regular lattices (every generated grid city)
+// snap by rounding; irregular node sets go through a uniform-grid spatial
+// hash searched in expanding rings.
+
+#pragma once
+
+#include "flat_array.h"
+#include "sim_types.h"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+class RoadSnapper
+{
+public:
+    RoadSnapper() = default;
+    explicit RoadSnapper(const FlatArray<Vec2> &nodes) { build(nodes); }
+
+    void build(const FlatArray<Vec2> &nodes)
+    {
+        pos = nodes;
+        regular = buildLattice();
+        if (!regular)
+            buildHash();
+    }
+
+    bool isRegular() const { return regular; }
+
+    // Node id closest to p (Euclidean), -1 when there are no nodes.
+    int nearest(Vec2 p) const
+    {
+        if (pos.empty())
+            return -1;
+        if (regular)
+        {
+            int ix = clampi((int)lroundf((p.x - originX) / stepX), 0, cols - 1);
+            int iy = clampi((int)lroundf((p.y - originY) / stepY), 0, rows - 1);
+            return latticeNode[iy * cols + ix];
+        }
+        return nearestHashed(p);
+    }
+
+    // Every stored member in a fixed order, see RoadGraph::visitStorage.
+    template <typename Self, typename V>
+    static void visitStorage(Self &s, V &v)
+    {
+        v.array("SPOS", s.pos);
+        v.value("SREG", s.regular);
+        v.value("SOX ", s.originX);
+        v.value("SOY ", s.originY);
+        v.value("SSTX", s.stepX);
+        v.value("SSTY", s.stepY);
+        v.value("SCOL", s.cols);
+        v.value("SROW", s.rows);
+        v.array("SLAN", s.latticeNode);
+        v.value("SMNX", s.minX);
+        v.value("SMNY", s.minY);
+        v.value("SCEL", s.cellSize);
+        v.value("SGW ", s.gridW);
+        v.value("SGH ", s.gridH);
+        v.array("SCST", s.cellStart);
+        v.array("SCND", s.cellNodes);
+    }
+
+    bool consistent() const
+    {
+        if (regular)
+            return latticeNode.size() == (size_t)cols * rows;
+        return pos.empty() || (cellStart.size() == (size_t)gridW * gridH + 1 && (size_t)cellStart.back() == cellNodes.size());
+    }
+
+private:
+    FlatArray<Vec2> pos;
+    bool regular = false;
+
+    // regular lattice
+    float originX = 0, originY = 0, stepX = 1, stepY = 1;
+    int cols = 0, rows = 0;
+    FlatArray<int> latticeNode;
+
+    // spatial hash, nodes of cell c are cellNodes[cellStart[c] .. cellStart[c + 1])
+    float minX = 0, minY = 0, cellSize = 1;
+    int gridW = 0, gridH = 0;
+    FlatArray<int> cellStart, cellNodes;
+
+    static int clampi(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+    static vector<float> distinct(vector<float> v)
+    {
+        sort(v.begin(), v.end());
+        vector<float> out;
+        for (float x : v)
+            if (out.empty() || x - out.back() > 0.5f)
+                out.push_back(x);
+        return out;
+    }
+
+    // True when the nodes are exactly the points of a fully populated,
+    // evenly spaced lattice; fills latticeNode in that case.
+    bool buildLattice()
+    {
+        if (pos.empty())
+            return false;
+        vector<float> xs, ys;
+        for (auto &p : pos)
+        {
+            xs.push_back(p.x);
+            ys.push_back(p.y);
+        }
+        xs = distinct(xs);
+        ys = distinct(ys);
+        cols = (int)xs.size();
+        rows = (int)ys.size();
+        if ((size_t)cols * rows != pos.size())
+            return false;
+        originX = xs[0];
+        originY = ys[0];
+        stepX = cols > 1 ? (xs.back() - xs[0]) / (cols - 1) : 1.0f;
+        stepY = rows > 1 ? (ys.back() - ys[0]) / (rows - 1) : 1.0f;
+        for (int i = 0; i < cols; ++i)
+            if (fabsf(xs[i] - (originX + i * stepX)) > 0.5f)
+                return false;
+        for (int i = 0; i < rows; ++i)
+            if (fabsf(ys[i] - (originY + i * stepY)) > 0.5f)
+                return false;
+        latticeNode.assign((size_t)cols * rows, -1);
+        for (int n = 0; n < (int)pos.size(); ++n)
+        {
+            int ix = (int)lroundf((pos[n].x - originX) / stepX);
+            int iy = (int)lroundf((pos[n].y - originY) / stepY);
+            int &slot = latticeNode[iy * cols + ix];
+            if (slot != -1)
+                return false;
+            slot = n;
+        }
+        return true;
+    }
+
+    void buildHash()
+    {
+        float maxX = -numeric_limits<float>::max(), maxY = -numeric_limits<float>::max();
+        minX = minY = numeric_limits<float>::max();
+        for (auto &p : pos)
+        {
+            minX = min(minX, p.x);
+            minY = min(minY, p.y);
+            maxX = max(maxX, p.x);
+            maxY = max(maxY, p.y);
+        }
+        // about two nodes per cell
+        float area = max(maxX - minX, 1.0f) * max(maxY - minY, 1.0f);
+        cellSize = max(sqrtf(area * 2.0f / pos.size()), 1.0f);
+        gridW = (int)((maxX - minX) / cellSize) + 1;
+        gridH = (int)((maxY - minY) / cellSize) + 1;
+
+        cellStart.assign((size_t)gridW * gridH + 1, 0);
+        for (auto &p : pos)
+            cellStart[cellOf(p) + 1]++;
+        for (size_t i = 1; i < cellStart.size(); ++i)
+            cellStart[i] += cellStart[i - 1];
+        cellNodes.resize(pos.size());
+        vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+        for (int n = 0; n < (int)pos.size(); ++n)
+            cellNodes[fill[cellOf(pos[n])]++] = n;
+    }
+
+    int cellX(float x) const { return clampi((int)((x - minX) / cellSize), 0, gridW - 1); }
+    int cellY(float y) const { return clampi((int)((y - minY) / cellSize), 0, gridH - 1); }
+    int cellOf(Vec2 p) const { return cellY(p.y) * gridW + cellX(p.x); }
+
+    int nearestHashed(Vec2 p) const
+    {
+        int cx = cellX(p.x), cy = cellY(p.y);
+        int best = -1;
+        float bestd = numeric_limits<float>::max();
+        int maxRing = max(gridW, gridH);
+        for (int r = 0; r <= maxRing; ++r)
+        {
+            for (int y = cy - r; y <= cy + r; ++y)
+            {
+                if (y < 0 || y >= gridH)
+                    continue;
+                // interior rows only need the two edge cells of the ring
+                int step = (y == cy - r || y == cy + r) ? 1 : max(2 * r, 1);
+                for (int x = cx - r; x <= cx + r; x += step)
+                {
+                    if (x < 0 || x >= gridW)
+                        continue;
+                    int c = y * gridW + x;
+                    for (int k = cellStart[c]; k < cellStart[c + 1]; ++k)
+                    {
+                        int n = cellNodes[k];
+                        float dx = pos[n].x - p.x, dy = pos[n].y - p.y;
+                        float d = dx * dx + dy * dy;
+                        if (d < bestd)
+                        {
+                            bestd = d;
+                            best = n;
+                        }
+                    }
+                }
+            }
+            // anything in ring r + 1 is at least r cells away
+            float bound = r * cellSize;
+            if (best >= 0 && bestd <= bound * bound)
+                break;
+        }
+        return best;
+    }
+};
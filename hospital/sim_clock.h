@@ -0,0 +1,119 @@
+// Simulation time. The simulation counts time in integer microseconds and
+// advances it by a fixed step, so the clock after N steps is exactly N
+// steps and nothing depends on how fast frames or wall time went by.
+// SimClock decides how many of those steps are due against wall time: a
+// speed multiplier from 1x to 10000x, pause, and single steps while paused.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+using namespace std;
+
+using SimMicros = int64_t;
+
+inline SimMicros toMicros(double seconds) { return (SimMicros)llround(seconds * 1e6); }
+inline double toSeconds(SimMicros t) { return (double)t * 1e-6; }
+
+// Paces fixed steps against wall time. The controls (speed, pause, step)
+// may be called from any thread; elapse/takeStep/untilNextStep belong to
+// the one thread that runs the steps.
+class SimClock
+{
+public:
+    static constexpr double minSpeed = 1.0, maxSpeed = 10000.0;
+    static constexpr double maxLagSeconds = 0.25; // wall-time backlog kept before steps are dropped
+
+    explicit SimClock(SimMicros stepMicros) : step(max<SimMicros>(1, stepMicros)) {}
+
+    void setSpeed(double x) { speedX.store(min(max(x, minSpeed), maxSpeed), memory_order_relaxed); }
+    double speed() const { return speedX.load(memory_order_relaxed); }
+
+    // Next or previous setting of 1, 2, 5, 10, 20, 50, ... 10000.
+    void faster() { setSpeed(nextSetting(speed(), +1)); }
+    void slower() { setSpeed(nextSetting(speed(), -1)); }
+
+    void setPaused(bool p) { pausedFlag.store(p, memory_order_relaxed); }
+    void togglePaused() { setPaused(!paused()); }
+    bool paused() const { return pausedFlag.load(memory_order_relaxed); }
+
+    // Runs n more steps whatever the pace, typically while paused.
+    void stepOnce(int n = 1) { manual.fetch_add(n, memory_order_relaxed); }
+
+    SimMicros stepMicros() const { return step; }
+
+    // Stepping thread: wallSeconds more real time went by. Time owed beyond
+    // maxLagSeconds of wall time at the current speed is dropped, so a
+    // simulation that cannot keep up runs as fast as it can, not ever
+    // further behind.
+    void elapse(double wallSeconds)
+    {
+        if (paused())
+        {
+            budget = 0.0;
+            return;
+        }
+        double rate = speed() * 1e6; // sim microseconds per wall second
+        budget += wallSeconds * rate;
+        double cap = max((double)step, maxLagSeconds * rate);
+        if (budget > cap)
+        {
+            dropped.fetch_add((long long)((budget - cap) / step), memory_order_relaxed);
+            budget = cap;
+        }
+    }
+
+    // Stepping thread: true, and the step is taken off the budget, when
+    // one is due.
+    bool takeStep()
+    {
+        if (manual.load(memory_order_relaxed) > 0)
+        {
+            manual.fetch_sub(1, memory_order_relaxed);
+            return true;
+        }
+        if (paused() || budget < (double)step)
+            return false;
+        budget -= (double)step;
+        return true;
+    }
+
+    // Stepping thread: wall seconds until the next step falls due.
+    double untilNextStep() const
+    {
+        if (paused())
+            return 0.01; // wake up now and then for single steps
+        return max(0.0, ((double)step - budget) / (speed() * 1e6));
+    }
+
+    // Steps skipped because the simulation could not keep up.
+    long long droppedSteps() const { return dropped.load(memory_order_relaxed); }
+
+private:
+    SimMicros step;
+    atomic<double> speedX{1.0};
+    atomic<bool> pausedFlag{false};
+    atomic<int> manual{0};
+    double budget = 0.0; // sim microseconds due but not yet stepped
+    atomic<long long> dropped{0};
+
+    static double nextSetting(double x, int dir)
+    {
+        static const double settings[] = {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000, 10000};
+        const int n = sizeof settings / sizeof settings[0];
+        if (dir > 0)
+        {
+            for (int i = 0; i < n; ++i)
+                if (settings[i] > x * 1.0001)
+                    return settings[i];
+            return settings[n - 1];
+        }
+        for (int i = n - 1; i >= 0; --i)
+            if (settings[i] < x * 0.9999)
+                return settings[i];
+        return settings[0];
+    }
+};
@@ -0,0 +1,124 @@
+// Runs a Simulation on its own thread, paced by a SimClock (real time or up
+// to 10000x faster, pausable), and hands finished WorldSnapshots to the
+// render thread through a triple buffer, so neither side ever waits for
+// the other: a slow frame no longer delays dispatch, and a busy tick never
+// stalls a frame. The steps themselves are fixed, so a session runs the
+// same at any speed and frame rate.
+
+#pragma once
+
+#include "simulation.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Lock-free triple buffer, one writer and one reader. The writer fills its
+// private buffer and swaps it with the shared "ready" slot; the reader swaps
+// its private buffer with the ready slot whenever a newer one is there. Each
+// side only ever touches the buffer it currently owns.
+class SnapshotBuffer
+{
+public:
+    // Writer side.
+    WorldSnapshot &writeBuffer() { return bufs[writeIdx]; }
+    void publish() { writeIdx = ready.exchange(writeIdx | freshBit, memory_order_acq_rel) & indexMask; }
+
+    // Reader side: newest published snapshot, valid until the next call.
+    const WorldSnapshot &latest()
+    {
+        if (ready.load(memory_order_acquire) & freshBit)
+            readIdx = ready.exchange(readIdx, memory_order_acq_rel) & indexMask;
+        return bufs[readIdx];
+    }
+
+private:
+    static const int freshBit = 4, indexMask = 3;
+    WorldSnapshot bufs[3];
+    int writeIdx = 0, readIdx = 1;
+    atomic<int> ready{2};
+};
+
+class SimulationThread
+{
+public:
+    explicit SimulationThread(Simulation &simulation) : sim(simulation), pace(simulation.fixedStepMicros())
+    {
+        sim.snapshot(buffer.writeBuffer());
+        buffer.publish();
+    }
+
+    ~SimulationThread() { stop(); }
+
+    SimulationThread(const SimulationThread &) = delete;
+    SimulationThread &operator=(const SimulationThread &) = delete;
+
+    void start()
+    {
+        if (running.exchange(true))
+            return;
+        worker = thread([this]() { run(); });
+    }
+
+    // Joins the thread; afterwards the Simulation may be used directly again.
+    void stop()
+    {
+        running = false;
+        if (worker.joinable())
+            worker.join();
+    }
+
+    // Render thread only.
+    const WorldSnapshot &latest() { return buffer.latest(); }
+
+    // Speed, pause and single steps; any thread.
+    SimClock &clock() { return pace; }
+
+    // Ticks run so far, and ticks skipped because the simulation could not
+    // keep up with the requested speed.
+    long long ticks() const { return tickCount.load(memory_order_relaxed); }
+    long long lateTicks() const { return pace.droppedSteps(); }
+
+private:
+    using Clock = chrono::steady_clock;
+    static constexpr double maxBatchSeconds = 1.0 / 60; // stepping between snapshots, at most
+
+    Simulation &sim;
+    SimClock pace;
+    SnapshotBuffer buffer;
+    thread worker;
+    atomic<bool> running{false};
+    atomic<long long> tickCount{0};
+
+    // Runs the steps the clock says are due, publishing a snapshot at least
+    // every maxBatchSeconds so fast-forward still animates, then sleeps
+    // until the next step is due (at most a millisecond, so speed changes
+    // take effect at once).
+    void run()
+    {
+        Profiler::instance().nameThread("sim");
+        auto last = Clock::now();
+        while (running.load(memory_order_relaxed))
+        {
+            auto now = Clock::now();
+            pace.elapse(chrono::duration<double>(now - last).count());
+            last = now;
+            const auto batchEnd = now + chrono::duration_cast<Clock::duration>(chrono::duration<double>(maxBatchSeconds));
+            int steps = 0;
+            while (pace.takeStep())
+            {
+                sim.step();
+                if (++steps % 64 == 0 && Clock::now() >= batchEnd)
+                    break;
+            }
+            if (steps > 0)
+            {
+                tickCount.fetch_add(steps, memory_order_relaxed);
+                PROFILE_ZONE("sim.snapshot");
+                sim.snapshot(buffer.writeBuffer());
+                buffer.publish();
+            }
+            this_thread::sleep_for(chrono::duration<double>(min(pace.untilNextStep(), 0.001)));
+        }
+    }
+};
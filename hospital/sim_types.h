@@ -0,0 +1,164 @@
+// Core simulation types shared by the renderer and the headless tools.
+// Nothing in here may depend on raylib.
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// ----------------------------- Math ----------------------------------------
+
+struct Vec2
+{
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+struct Rect
+{
+    float x = 0.0f;
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+struct Rgba
+{
+    unsigned char r = 0, g = 0, b = 0, a = 255;
+};
+
+inline bool pointInRect(Vec2 p, const Rect &r)
+{
+    return p.x >= r.x && p.x < r.x + r.width && p.y >= r.y && p.y < r.y + r.height;
+}
+
+// ----------------------------- Types ---------------------------------------
+
+// GRID: the regular grid city. GENERATED: irregular blocks, arterials and
+// dead ends from city_gen.h.
+enum class CityLayout : unsigned char
+{
+    GRID,
+    GENERATED
+};
+
+// Parameters of a generated city; the seed fixes the layout and the houses.
+struct CityConfig
+{
+    int blocksX = 3, blocksY = 3;
+    float blockSize = 200.0f;
+    float roadW = 44.0f, sidewalk = 10.0f;
+    float startX = 100.0f, startY = 100.0f;
+    int lotsX = 3, lotsY = 2;
+    unsigned seed = 0;
+
+    // GENERATED layout only
+    CityLayout layout = CityLayout::GRID;
+    float jitter = 0.0f;     // spread of block sizes, fraction of blockSize
+    int arterialEvery = 0;   // mean blocks between arterial roads, 0 = none
+    float arterialW = 72.0f; // arterial road width
+    float deadEnds = 0.0f;   // share of local north-south roads cut short
+};
+
+struct House
+{
+    Rect body;
+    Rgba color;
+    int id;
+    bool highlighted = false;
+    bool hasEmergency = false;
+
+    // point on the sidewalk in front of the door, used as the emergency location
+    Vec2 frontDoor() const { return Vec2{body.x + body.width / 2.0f, body.y + body.height}; }
+};
+
+struct Road
+{
+    Rect rect;
+    bool horizontal;
+    bool closed = false;
+    int oneWay = 0; // 0 = both ways, +1 = towards increasing x/y only, -1 = decreasing only
+};
+
+struct Ambulance
+{
+    int id = 0;
+    Vec2 pos = {0, 0};
+    Vec2 parkingPos = {0, 0};
+    float speed = 150.0f;
+    int assignedEmergencyId = -1;
+    int assignedHouseId = -1;
+
+    enum class Status : unsigned char
+    {
+        IDLE,
+        TO_SCENE,
+        ON_SCENE,
+        RETURNING
+    } status = Status::IDLE;
+    Rect bounds() const { return Rect{pos.x - 10, pos.y - 8, 20, 16}; }
+
+    string_view getStatusString() const;
+};
+
+// Display name of a unit status; static storage, no allocation.
+inline string_view statusName(Ambulance::Status s)
+{
+    switch (s)
+    {
+    case Ambulance::Status::IDLE:
+        return "IDLE";
+    case Ambulance::Status::TO_SCENE:
+        return "EN ROUTE";
+    case Ambulance::Status::ON_SCENE:
+        return "ON SCENE";
+    case Ambulance::Status::RETURNING:
+        return "RETURNING";
+    default:
+        return "UNKNOWN";
+    }
+}
+
+inline string_view Ambulance::getStatusString() const { return statusName(status); }
+
+struct PatientInfo
+{
+    string name;
+    int age = 0;
+    string severity;
+    string desc;
+    int houseNumber = -1;
+};
+
+struct Emergency
+{
+    int id = 0;
+    PatientInfo patient;
+    Vec2 location = {0, 0};
+    int priority = 3;
+    double createdAt = 0.0;
+    int assignedHospital = -1;
+    int callId = 0; // call number handed to the call-taker by Simulation::post
+};
+
+// Dispatch order: most urgent priority first, then oldest call, then lowest id.
+struct EmergencyKey
+{
+    int priority = 3;
+    double createdAt = 0.0;
+    int id = 0;
+
+    bool operator<(const EmergencyKey &o) const
+    {
+        if (priority != o.priority)
+            return priority < o.priority;
+        if (createdAt != o.createdAt)
+            return createdAt < o.createdAt;
+        return id < o.id;
+    }
+};
+
+inline EmergencyKey dispatchKey(const Emergency &e) { return EmergencyKey{e.priority, e.createdAt, e.id}; }
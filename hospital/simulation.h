@@ -0,0 +1,1262 @@
+// Headless fleet simulation: city map, hospitals and the
+// fixed-timestep Simulation driver. No raylib dependency; the renderer in
+// main.cpp only reads a WorldSnapshot.
+
+#pragma once
+
+#include "sim_types.h"
+#include "road_graph.h"
+#include "road_snapper.h"
+#include "ambulance_index.h"
+#include "indexed_heap.h"
+#include "fleet_store.h"
+#include "hospital_locator.h"
+#include "event_log.h"
+#include "assignment.h"
+#include "intake_queue.h"
+#include "house_picker.h"
+#include "profiler.h"
+#include "metrics.h"
+#include "sim_clock.h"
+#include "distance_table.h"
+
+#include <cmath>
+#include <unordered_map>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+// ----------------------------- City map -----------------------------------
+
+struct CityMap
+{
+    CityConfig cfg;
+    float mapWidth = 0.0f, mapHeight = 0.0f;
+    FlatArray<Road> roads;
+    FlatArray<House> houses;
+    FlatArray<int> houseById; // house id -> index in houses, -1 for unused ids
+    HousePicker housePicker;
+    RoadGraph graph;
+    RoadSnapper snapper; // nearest intersection of any point
+    shared_ptr<const DistanceTable> distances; // all-pairs road distances, if built (Simulation::setDistanceTable)
+    shared_ptr<const void> backing; // mapped city file the arrays view, if any (city_file.h)
+
+    Rect bounds() const { return Rect{cfg.startX - cfg.roadW, cfg.startY - cfg.roadW, mapWidth, mapHeight}; }
+
+    // Index of house `id` in houses, -1 if there is none.
+    int houseIndex(int id) const { return id >= 0 && id < (int)houseById.size() ? houseById[id] : -1; }
+
+    // Index of the house whose body contains p, -1 if none.
+    int houseAt(Vec2 p) const { return housePicker.pick(p); }
+
+    // House ids are handed out sequentially, so the id index is a plain
+    // array. Call after changing houses.
+    void indexHouses()
+    {
+        int maxId = -1;
+        for (auto &h : houses)
+            maxId = max(maxId, h.id);
+        houseById.assign(maxId + 1, -1);
+        for (size_t i = 0; i < houses.size(); ++i)
+            if (houses[i].id >= 0)
+                houseById[houses[i].id] = (int)i;
+        housePicker.build(houses);
+    }
+    // Road route between two arbitrary points, see RoadGraph::route.
+    float route(Vec2 start, Vec2 end, vector<Vec2> &out) const
+    {
+        return graph.route(snapper.nearest(start), snapper.nearest(end), end, out);
+    }
+};
+
+inline CityMap buildGridCity(const CityConfig &cfg)
+{
+    CityMap m;
+    m.cfg = cfg;
+    m.mapWidth = cfg.blocksX * cfg.blockSize + cfg.roadW * 2;
+    m.mapHeight = cfg.blocksY * cfg.blockSize + cfg.roadW * 2;
+    const float roadW = cfg.roadW, blockSize = cfg.blockSize;
+
+    // roads
+    for (int y = 0; y <= cfg.blocksY; ++y)
+    {
+        float ry = cfg.startY + y * blockSize;
+        m.roads.push_back({Rect{cfg.startX - roadW / 2.0f, ry - roadW / 2.0f, m.mapWidth + roadW, roadW}, true});
+    }
+    for (int x = 0; x <= cfg.blocksX; ++x)
+    {
+        float rx = cfg.startX + x * blockSize;
+        m.roads.push_back({Rect{rx - roadW / 2.0f, cfg.startY - roadW / 2.0f, roadW, m.mapHeight + roadW}, false});
+    }
+
+    m.graph.build(m.roads);
+    m.snapper.build(m.graph.positions());
+
+    // houses
+    int houseId = 1;
+    mt19937 rng(cfg.seed);
+    auto rndf = [&](float a, float b)
+    { uniform_real_distribution<float>d(a,b); return d(rng); };
+    auto rndi = [&](int a, int b)
+    { uniform_int_distribution<int>d(a,b); return d(rng); };
+    float pad = 8.0f;
+    for (int py = 0; py < cfg.blocksY * cfg.lotsY; ++py)
+    {
+        for (int px = 0; px < cfg.blocksX * cfg.lotsX; ++px)
+        {
+            int by = py / cfg.lotsY, ly = py % cfg.lotsY;
+            int bx = px / cfg.lotsX, lx = px % cfg.lotsX;
+            float blockX = cfg.startX + bx * blockSize + roadW / 2.0f;
+            float blockY = cfg.startY + by * blockSize + roadW / 2.0f;
+            float usableW = blockSize - roadW, usableH = blockSize - roadW;
+            float lotW = usableW / cfg.lotsX, lotH = usableH / cfg.lotsY;
+            float x = blockX + lx * lotW + pad / 2.0f, y = blockY + ly * lotH + pad / 2.0f;
+            float w = lotW - pad, h = lotH - pad;
+            float vw = w * rndf(0.75f, 0.95f), vh = h * rndf(0.55f, 0.85f);
+            Rect body = {x + (w - vw) / 2.0f, y + (h - vh) / 2.0f + vh * 0.08f, vw, vh};
+            m.houses.push_back({body, Rgba{(unsigned char)rndi(60, 220), (unsigned char)rndi(60, 220), (unsigned char)rndi(60, 220), 255}, houseId++, false, false});
+        }
+    }
+    m.indexHouses();
+    return m;
+}
+
+// ----------------------------- Hospital -----------------------------------
+
+// GREEDY: the most urgent call takes its nearest idle unit, then the next.
+// BATCH: all calls that can be served right now are matched to idle units
+// at once, minimising priority-weighted travel (see dispatchBatch).
+enum class DispatchMode : unsigned char
+{
+    GREEDY,
+    BATCH
+};
+
+// "greedy" or "batch", as the --dispatch options take it.
+inline bool parseDispatchMode(const string &s, DispatchMode &out)
+{
+    if (s == "greedy")
+        out = DispatchMode::GREEDY;
+    else if (s == "batch")
+        out = DispatchMode::BATCH;
+    else
+        return false;
+    return true;
+}
+
+// A unit was sent to a house (+1) or left its scene (-1).
+struct IncidentChange
+{
+    int houseId;
+    int delta;
+};
+
+// Operational figures the simulation feeds into a MetricsRegistry. Times
+// are sim time, recorded in microseconds and exported in seconds.
+struct SimMetrics
+{
+    static const int priorities = 3;
+
+    Counter &calls, &dispatched, &handled, &lent, &dropped;
+    Counter &busyUnitMicros, &unitMicros; // utilization = rate(busy) / rate(units)
+    Histogram &callToDispatch, &dispatchToScene, &onScene;
+    Histogram *queueWait[priorities]; // by Emergency::priority, 1 first
+    Gauge &queueDepth, &busyUnits, &units, &utilization;
+
+    explicit SimMetrics(MetricsRegistry &r)
+        : calls(r.counter("ems_calls_total", "Calls received.")),
+          dispatched(r.counter("ems_dispatches_total", "Units sent to a call.")),
+          handled(r.counter("ems_calls_handled_total", "Calls whose scene work is done.")),
+          lent(r.counter("ems_calls_lent_total", "Calls handed to a neighbouring hospital.")),
+          dropped(r.counter("ems_calls_dropped_total", "Calls no hospital could take.")),
+          busyUnitMicros(r.counter("ems_unit_busy_microseconds_total", "Unit time spent away from the bay, sim microseconds.")),
+          unitMicros(r.counter("ems_unit_microseconds_total", "Unit time in service, sim microseconds.")),
+          callToDispatch(r.histogram("ems_call_to_dispatch_seconds", "Call received to unit assigned.", "", 1e-6)),
+          dispatchToScene(r.histogram("ems_dispatch_to_scene_seconds", "Unit assigned to unit on scene.", "", 1e-6)),
+          onScene(r.histogram("ems_on_scene_seconds", "Time a unit works a scene.", "", 1e-6)),
+          queueDepth(r.gauge("ems_queue_depth", "Calls waiting for a unit.")),
+          busyUnits(r.gauge("ems_units_busy", "Units away from their bay.")),
+          units(r.gauge("ems_units", "Units in service.")),
+          utilization(r.gauge("ems_fleet_utilization", "Busy units over all units, last tick."))
+    {
+        for (int p = 0; p < priorities; ++p)
+            queueWait[p] = &r.histogram("ems_queue_wait_seconds", "Time a call waits for a unit, by priority.",
+                                        "priority=\"" + to_string(p + 1) + "\"", 1e-6);
+    }
+};
+
+// ----------------------------- Fleet events -------------------------------
+
+// What a unit waits for; its status tells which. Each unit has at most one
+// event scheduled, at the time its drive or scene work ends.
+enum class FleetEvent : unsigned char
+{
+    NONE,
+    ARRIVE_SCENE, // TO_SCENE: the route to the call is driven
+    LEAVE_SCENE,  // ON_SCENE: the scene work is done
+    ARRIVE_BASE   // RETURNING: the route back is driven
+};
+
+inline FleetEvent pendingEvent(Ambulance::Status s)
+{
+    switch (s)
+    {
+    case Ambulance::Status::TO_SCENE:
+        return FleetEvent::ARRIVE_SCENE;
+    case Ambulance::Status::ON_SCENE:
+        return FleetEvent::LEAVE_SCENE;
+    case Ambulance::Status::RETURNING:
+        return FleetEvent::ARRIVE_BASE;
+    default:
+        return FleetEvent::NONE;
+    }
+}
+
+// Event order: time, then unit, so simultaneous events run the same way
+// every time.
+struct FleetEventKey
+{
+    SimMicros at = 0;
+    int unit = 0;
+    bool operator<(const FleetEventKey &o) const { return at != o.at ? at < o.at : unit < o.unit; }
+};
+
+// Sim time to drive `length` at `speed` px/s, rounded up to a microsecond.
+inline SimMicros driveMicros(float length, float speed) { return (SimMicros)ceil((double)length / speed * 1e6); }
+
+class Hospital
+{
+public:
+    Hospital(Vec2 loc, const vector<Vec2> &parkingPositions, int startAmbId = 1, float onSceneDuration = 4.0f)
+        : location(loc), nextEmergencyId(1), onSceneDurationSec(onSceneDuration), onSceneMicros(toMicros(onSceneDuration))
+    {
+        int aid = startAmbId;
+        for (auto &p : parkingPositions)
+        {
+            Ambulance a;
+            a.id = aid++;
+            a.parkingPos = p;
+            a.pos = p;
+            a.status = Ambulance::Status::IDLE;
+            fleet.add(a);
+            cruiseSpeed = a.speed;
+        }
+        Rect area = {loc.x, loc.y, 0, 0};
+        for (auto &p : parkingPositions)
+        {
+            area.width = max(area.width, fabsf(p.x - loc.x) * 2);
+            area.height = max(area.height, fabsf(p.y - loc.y) * 2);
+        }
+        area.x -= area.width / 2;
+        area.y -= area.height / 2;
+        indexFleet(area);
+    }
+
+    // Record this hospital's decisions as hospital number `index`; nullptr stops.
+    void attachLog(EventLog *eventLog, int index)
+    {
+        log = eventLog;
+        logIndex = index;
+    }
+
+    // Rebuild the idle-unit index over a service area; cellSize ~ one block.
+    void indexFleet(Rect area, float cellSize = 200.0f)
+    {
+        idleIndex.reset(area, cellSize);
+        for (int i = 0; i < fleet.size(); ++i)
+            if (fleet.status[i] == Ambulance::Status::IDLE)
+                idleIndex.insert(i, fleet.pos(i));
+    }
+
+    int receiveEmergency(const Emergency &incoming, double now)
+    {
+        Emergency e = incoming;
+        e.id = nextEmergencyId++;
+        e.createdAt = now;
+        int id = e.id;
+        queue_.push(id, dispatchKey(e));
+        pending_.emplace(id, move(e));
+        dispatchPending = true;
+        queueVersion_++;
+        return id;
+    }
+
+    // Withdraw a call that is still waiting for a unit.
+    bool cancelEmergency(int id)
+    {
+        if (!queue_.erase(id))
+            return false;
+        pending_.erase(id);
+        queueVersion_++;
+        return true;
+    }
+
+    // Change the priority of a waiting call (e.g. the caller reports the
+    // patient got worse); its place in the queue is adjusted in O(log n).
+    bool reprioritize(int id, int priority)
+    {
+        auto it = pending_.find(id);
+        if (it == pending_.end())
+            return false;
+        it->second.priority = priority;
+        queue_.update(id, dispatchKey(it->second));
+        dispatchPending = true;
+        queueVersion_++;
+        return true;
+    }
+
+    // Feed `m` (nullptr stops).
+    void attachMetrics(SimMetrics *m) { metrics = m; }
+    // Sim time the next decisions happen at; the owner sets it every tick.
+    void setClock(SimMicros now) { clock = now; }
+
+    void setDispatchMode(DispatchMode m) { mode = m; }
+    DispatchMode dispatchMode() const { return mode; }
+
+    // Assigns waiting calls in priority order while idle units remain. Only
+    // does work after a call arrived or a unit became idle since last time.
+    // Returns the number of units sent.
+    int dispatchVehicles(const CityMap &city)
+    {
+        if (!dispatchPending)
+            return 0;
+        dispatchPending = false;
+        if (mode == DispatchMode::BATCH && queue_.size() > 1 && idleIndex.size() > 1)
+            return dispatchBatch(city);
+        int sent = 0;
+        while (!queue_.empty() && idleIndex.size() > 0)
+        {
+            int idx = findNearestAvailableAmbulance(pending_.at(queue_.topId()).location, city);
+            if (idx < 0)
+                break;
+            assign(queue_.topId(), idx, city);
+            sent++;
+        }
+        return sent;
+    }
+
+    // Batch mode: the min(waiting, idle) most urgent calls - exactly the ones
+    // greedy dispatch would serve now - are matched to idle units by a
+    // min-cost assignment, so one call cannot take the only close unit of
+    // another. Cost is travel distance weighted by urgency.
+    int dispatchBatch(const CityMap &city)
+    {
+        int k = min(min(queue_.size(), idleIndex.size()), maxBatch);
+        queue_.topK(k, batchCalls);
+        idleIndex.collect(batchUnits);
+        int m = (int)batchUnits.size();
+        batchCost.resize((size_t)k * m);
+        for (int i = 0; i < k; ++i)
+        {
+            const Emergency &em = pending_.at(batchCalls[i]);
+            float w = priorityWeight(em.priority);
+            float *row = batchCost.data() + (size_t)i * m;
+            for (int j = 0; j < m; ++j)
+                row[j] = w * travelEstimate(fleet.pos(batchUnits[j]), em.location);
+        }
+        solver.solve(batchCost, k, m, batchMatch);
+        for (int i = 0; i < k; ++i)
+            assign(batchCalls[i], batchUnits[batchMatch[i]], city);
+        if (!queue_.empty() && idleIndex.size() > 0)
+            dispatchPending = true; // more than maxBatch could be served; continue next tick
+        return k;
+    }
+
+    // Urgent calls count more: each priority level doubles the weight.
+    static float priorityWeight(int priority) { return (float)(1 << (3 - min(max(priority, 1), 3))); }
+
+    // Road distance on the open grid, where routes are Manhattan paths; the
+    // same lower bound A* works with when roads are closed.
+    static float travelEstimate(Vec2 from, Vec2 to) { return fabsf(from.x - to.x) + fabsf(from.y - to.y); }
+
+    // Runs the unit events due at or before `until` in time order, each at
+    // its own time, and returns how many ran. Cost follows the events, not
+    // the fleet size.
+    int processEvents(const CityMap &city, SimMicros until)
+    {
+        int n = 0;
+        while (!events.empty() && events.topKey().at <= until)
+        {
+            FleetEventKey e = events.topKey();
+            events.pop();
+            clock = e.at;
+            handleEvent(e.unit, city);
+            n++;
+        }
+        return n;
+    }
+
+    // Sim time of the earliest scheduled unit event, or the largest
+    // SimMicros when none is.
+    SimMicros nextEventTime() const { return events.empty() ? numeric_limits<SimMicros>::max() : events.topKey().at; }
+
+    // Most urgent waiting call, nullptr when the queue is empty.
+    const Emergency *nextPending() const { return queue_.empty() ? nullptr : &pending_.at(queue_.topId()); }
+
+    // Remove a waiting call and hand it back, e.g. to pass it to another
+    // hospital that has a unit free.
+    bool takeEmergency(int id, Emergency &out)
+    {
+        auto it = pending_.find(id);
+        if (it == pending_.end())
+            return false;
+        queue_.erase(id);
+        out = move(it->second);
+        pending_.erase(it);
+        queueVersion_++;
+        return true;
+    }
+
+    // Seconds one call keeps a unit busy: drive out, work the scene, drive
+    // back at returning speed. Trip time is a running average over dispatches.
+    float serviceEstimate() const { return avgTripSec * (1.0f + 1.0f / 0.8f) + onSceneDurationSec; }
+    float unitSpeed() const { return cruiseSpeed; }
+
+    // The k most urgent waiting calls, most urgent first. Reads the heap in
+    // place; `out` is reused so steady-state calls do not allocate.
+    int peekPending(int k, vector<const Emergency *> &out) const
+    {
+        queue_.topK(k, topIds);
+        out.clear();
+        for (int id : topIds)
+            out.push_back(&pending_.at(id));
+        return (int)out.size();
+    }
+
+    // Bumped on every change to the waiting queue, so readers can cache views.
+    unsigned queueVersion() const { return queueVersion_; }
+
+    // Units sent to or leaving houses since the owner last cleared it.
+    vector<IncidentChange> &incidentChanges() { return incidents; }
+
+    const FleetStore &getFleet() const { return fleet; }
+    int fleetSize() const { return fleet.size(); }
+    int pendingCount() const { return (int)queue_.size(); }
+    int idleCount() const { return idleIndex.size(); }
+    bool dispatchDue() const { return dispatchPending; }
+    int handled() const { return handledCount; }
+    Vec2 getLocation() const { return location; }
+    float onSceneDuration() const { return onSceneDurationSec; }
+
+private:
+    Vec2 location;
+    FleetStore fleet;
+    vector<Vec2> routeScratch;
+    IndexedHeap<EmergencyKey> queue_;         // waiting call ids in dispatch order
+    unordered_map<int, Emergency> pending_; // waiting calls by id
+    bool dispatchPending = false;           // a call arrived or a unit freed up
+    unsigned queueVersion_ = 0;
+    mutable vector<int> topIds;             // peekPending scratch
+    vector<IncidentChange> incidents;
+    int nextEmergencyId;
+    int handledCount = 0;
+    float onSceneDurationSec;
+    SimMicros onSceneMicros;
+    float cruiseSpeed = 150.0f;
+    float avgTripSec = 2.0f; // ~300 px at cruise speed until real dispatches come in
+
+    // idle units sit at their parking bay, which is where they are indexed
+    IdleFleetIndex idleIndex;
+
+    DispatchMode mode = DispatchMode::GREEDY;
+    static constexpr int maxBatch = 500; // calls per assignment solve
+    AssignmentSolver solver;
+    vector<int> batchCalls, batchUnits, batchMatch;
+    vector<float> batchCost;
+
+    EventLog *log = nullptr;
+    int logIndex = 0;
+    SimMetrics *metrics = nullptr;
+    SimMicros clock = 0;
+
+    IndexedHeap<FleetEventKey> events; // by unit index, earliest first
+
+    void schedule(int i, SimMicros at)
+    {
+        fleet.due[i] = at;
+        events.push(i, FleetEventKey{at, i});
+    }
+
+    // Start unit i on its current route now; it arrives when the route is driven.
+    void depart(int i)
+    {
+        fleet.departAt[i] = clock;
+        schedule(i, clock + driveMicros(fleet.routeLength(i), fleet.speed[i] * fleet.motionFactor(i)));
+    }
+
+    void handleEvent(int i, const CityMap &city)
+    {
+        switch (pendingEvent(fleet.status[i]))
+        {
+        case FleetEvent::ARRIVE_SCENE:
+        {
+            if (fleet.pathLen[i] > 0)
+                fleet.setPos(i, fleet.path(i)[fleet.pathLen[i] - 1]);
+            fleet.clearPath(i);
+            setUnitStatus(i, Ambulance::Status::ON_SCENE);
+            schedule(i, clock + onSceneMicros);
+            AmbulanceTask &task = fleet.task[i];
+            task.arrivedAt = clock;
+            if (metrics)
+                metrics->dispatchToScene.record(clock - task.dispatchedAt);
+            break;
+        }
+        case FleetEvent::LEAVE_SCENE:
+            city.route(fleet.pos(i), fleet.parking(i), routeScratch);
+            fleet.setPath(i, routeScratch.data(), (int)routeScratch.size());
+            setUnitStatus(i, Ambulance::Status::RETURNING);
+            depart(i);
+            handledCount++;
+            if (metrics)
+            {
+                metrics->handled.add();
+                metrics->onScene.record(clock - fleet.task[i].arrivedAt);
+            }
+            incidents.push_back({fleet.task[i].houseId, -1});
+            fleet.task[i] = AmbulanceTask{};
+            break;
+        case FleetEvent::ARRIVE_BASE:
+            fleet.setPos(i, fleet.parking(i));
+            fleet.clearPath(i);
+            setUnitStatus(i, Ambulance::Status::IDLE);
+            idleIndex.insert(i, fleet.pos(i));
+            dispatchPending = true;
+            break;
+        case FleetEvent::NONE:
+            break;
+        }
+    }
+
+    void setUnitStatus(int i, Ambulance::Status s)
+    {
+        fleet.setStatus(i, s);
+        if (log)
+            log->status(logIndex, fleet.id[i], s);
+    }
+
+    int findNearestAvailableAmbulance(const Vec2 &target, const CityMap &city) const
+    {
+        return idleIndex.nearest(target, city.graph, city.snapper, city.distances.get());
+    }
+
+    // Send idle unit idx to waiting call id.
+    void assign(int id, int idx, const CityMap &city)
+    {
+        auto it = pending_.find(id);
+        const Emergency &em = it->second;
+        queue_.erase(id);
+        idleIndex.erase(idx);
+        float trip = city.route(fleet.pos(idx), em.location, routeScratch);
+        if (trip >= 0) // -1: straight-line fallback, not a trip time
+            avgTripSec += 0.1f * (trip / fleet.speed[idx] - avgTripSec);
+        fleet.setPath(idx, routeScratch.data(), (int)routeScratch.size());
+        AmbulanceTask &task = fleet.task[idx];
+        task.emergencyId = em.id;
+        task.patientName = em.patient.name;
+        task.houseId = em.patient.houseNumber;
+        task.dispatchedAt = clock;
+        incidents.push_back({task.houseId, +1});
+        if (metrics)
+        {
+            uint64_t wait = max<SimMicros>(0, clock - toMicros(em.createdAt));
+            metrics->dispatched.add();
+            metrics->callToDispatch.record(wait);
+            metrics->queueWait[min(max(em.priority, 1), SimMetrics::priorities) - 1]->record(wait);
+        }
+        if (log)
+            log->assign(logIndex, em.id, fleet.id[idx]);
+        setUnitStatus(idx, Ambulance::Status::TO_SCENE);
+        depart(idx);
+        pending_.erase(it);
+        queueVersion_++;
+    }
+};
+
+// ----------------------------- Hospital network ---------------------------
+
+// Picks which hospital takes a call and lets hospitals with spare units
+// answer calls queued at overloaded neighbours. Only the few hospitals
+// nearest a call are considered, found through a 2-d tree over their
+// locations, so a decision costs O(log H) however large the network.
+class HospitalNetwork
+{
+public:
+    static const int candidates = 4; // nearest hospitals scored per decision
+
+    void rebuild(const vector<Hospital> &hospitals)
+    {
+        vector<Vec2> locations;
+        for (auto &h : hospitals)
+            locations.push_back(h.getLocation());
+        locator.build(locations);
+    }
+
+    // Expected seconds until a unit from h reaches p: the drive (Manhattan,
+    // roads are axis-aligned) plus, when every idle unit is already spoken
+    // for, the wait for one of its busy units to come free.
+    static float estimateResponse(const Hospital &h, Vec2 p)
+    {
+        if (h.fleetSize() == 0)
+            return numeric_limits<float>::infinity();
+        Vec2 loc = h.getLocation();
+        float travel = (fabsf(p.x - loc.x) + fabsf(p.y - loc.y)) / h.unitSpeed();
+        int ahead = h.pendingCount() - h.idleCount();
+        if (ahead < 0)
+            return travel;
+        return travel + (ahead + 1) * h.serviceEstimate() / h.fleetSize();
+    }
+
+    // Hospital with the best estimated response to p, -1 with no hospitals.
+    int route(const vector<Hospital> &hospitals, Vec2 p) const
+    {
+        locator.kNearest(p, candidates, hits);
+        int best = -1;
+        float bestTime = numeric_limits<float>::infinity();
+        for (auto &hit : hits)
+        {
+            float t = estimateResponse(hospitals[hit.hospital], p);
+            if (best < 0 || t < bestTime)
+            {
+                best = hit.hospital;
+                bestTime = t;
+            }
+        }
+        return best;
+    }
+
+    // Cross-hospital lending: a hospital with calls waiting and no idle unit
+    // passes its most urgent call to a nearby hospital that has a unit to
+    // spare, if that unit gets there sooner than waiting would. The lender's
+    // unit serves the call and returns to its own base. At most one call per
+    // hospital per tick; returns the number of calls lent. Only the
+    // hospitals in `waiting` (ascending, every one with calls waiting among
+    // them) can lend out a call; each lender is appended to it.
+    int balance(vector<Hospital> &hospitals, vector<int> &waiting, EventLog *log = nullptr)
+    {
+        int lent = 0;
+        for (int wi = 0, n = (int)waiting.size(); wi < n; ++wi)
+        {
+            int hi = waiting[wi];
+            Hospital &h = hospitals[hi];
+            if (h.idleCount() > 0)
+                continue;
+            const Emergency *em = h.nextPending();
+            if (!em)
+                continue;
+            // h's own first free unit: on average one service time / fleet away
+            Vec2 loc = h.getLocation();
+            float stay = (fabsf(em->location.x - loc.x) + fabsf(em->location.y - loc.y)) / h.unitSpeed() +
+                         (h.fleetSize() ? h.serviceEstimate() / h.fleetSize() : numeric_limits<float>::infinity());
+            locator.kNearest(em->location, candidates, hits, hi);
+            int lender = -1;
+            float lenderTime = stay;
+            for (auto &hit : hits)
+            {
+                const Hospital &o = hospitals[hit.hospital];
+                if (o.idleCount() <= o.pendingCount())
+                    continue;
+                float t = estimateResponse(o, em->location);
+                if (t < lenderTime)
+                {
+                    lender = hit.hospital;
+                    lenderTime = t;
+                }
+            }
+            if (lender < 0)
+                continue;
+            Emergency moved;
+            h.takeEmergency(em->id, moved);
+            moved.assignedHospital = lender;
+            int newId = hospitals[lender].receiveEmergency(moved, moved.createdAt); // keeps its place in line
+            if (log)
+                log->lend(hi, moved.id, lender, newId);
+            waiting.push_back(lender);
+            lent++;
+        }
+        lentTotal += lent;
+        return lent;
+    }
+
+    int lentCount() const { return lentTotal; }
+
+private:
+    HospitalLocator locator;
+    mutable vector<HospitalLocator::Hit> hits; // query scratch
+    int lentTotal = 0;
+};
+
+// ----------------------------- Snapshot -----------------------------------
+
+// Everything the renderer needs for one frame. Filled by Simulation::snapshot,
+// buffers are reused between frames.
+struct AmbulanceView
+{
+    int id = 0;
+    int hospital = 0;
+    Vec2 pos, parkingPos;
+    Ambulance::Status status = Ambulance::Status::IDLE;
+    float onSceneTimer = 0.0f;
+    int assignedHouseId = -1;
+    int assignedEmergencyId = -1;
+    string assignedPatientName;
+    int pathBegin = 0, pathEnd = 0; // remaining route in WorldSnapshot::pathPoints
+
+    string_view getStatusString() const { return statusName(status); }
+};
+
+struct PendingView
+{
+    int id = 0;
+    int priority = 3;
+    string name, severity;
+};
+
+struct HospitalView
+{
+    Vec2 location;
+    int firstAmbulance = 0, ambulanceCount = 0;
+    int pending = 0, handled = 0;
+    vector<PendingView> pendingTop;  // most urgent first, at most queuePreview
+    unsigned queueVersion = ~0u;     // Hospital::queueVersion pendingTop was read at
+};
+
+struct WorldSnapshot
+{
+    static const int queuePreview = 3; // waiting calls copied per hospital
+
+    double simTime = 0.0;
+    long long tick = 0;
+    int totalEmergencies = 0;
+    vector<AmbulanceView> ambulances;
+    vector<Vec2> pathPoints;
+    vector<HospitalView> hospitals;
+    vector<int> activeHouses; // CityMap::houses indices with a unit en route or on scene
+};
+
+// ----------------------------- Simulation ---------------------------------
+
+// A call waiting in the intake ring.
+struct IntakeItem
+{
+    Emergency em;
+    int hospital = -1; // -1 = let the network route it
+};
+
+class Simulation
+{
+public:
+    // The step is rounded to whole microseconds: 1/120 s runs as 8333 us.
+    explicit Simulation(CityMap cityMap, float fixedStep = 1.0f / 120.0f, size_t intakeCapacity = 1 << 16)
+        : city(std::move(cityMap)), stepMicros(max<SimMicros>(1, toMicros(fixedStep))),
+          fixedDt((float)toSeconds(stepMicros)), intake(intakeCapacity)
+    {
+    }
+
+    Hospital &addHospital(Vec2 loc, const vector<Vec2> &parking, float onSceneDuration = 4.0f)
+    {
+        hospitals.emplace_back(loc, parking, nextAmbulanceId, onSceneDuration);
+        hospitals.back().setDispatchMode(dispatch);
+        nextAmbulanceId += (int)parking.size();
+        Rect area = city.bounds();
+        area.x -= city.cfg.blockSize;
+        area.y -= city.cfg.blockSize;
+        area.width += 2 * city.cfg.blockSize;
+        area.height += 2 * city.cfg.blockSize;
+        // one block per cell, coarser on huge maps so each index stays small
+        float cell = max(city.cfg.blockSize, sqrtf(area.width * area.height / maxFleetCells));
+        hospitals.back().indexFleet(area, cell);
+        network.rebuild(hospitals);
+        if (log)
+        {
+            log->hospital(loc, onSceneDuration, parking);
+            hospitals.back().attachLog(log, (int)hospitals.size() - 1);
+        }
+        hospitals.back().attachMetrics(metrics);
+        settled = false;
+        return hospitals.back();
+    }
+
+    // Record the session into `eventLog` (nullptr stops recording). Attach
+    // before the first step or submit: the log starts with the city and the
+    // hospitals as they are now, which is what a replay rebuilds.
+    void attachLog(EventLog *eventLog)
+    {
+        log = eventLog;
+        if (log)
+        {
+            log->setTick(tickCount);
+            log->config(city.cfg, fixedDt, (unsigned char)dispatch, city.distances != nullptr);
+            for (auto &h : hospitals)
+            {
+                vector<Vec2> parking;
+                for (int i = 0; i < h.fleetSize(); ++i)
+                    parking.push_back(h.getFleet().parking(i));
+                log->hospital(h.getLocation(), h.onSceneDuration(), parking);
+            }
+        }
+        for (int i = 0; i < (int)hospitals.size(); ++i)
+            hospitals[i].attachLog(log, i);
+    }
+
+    // Feed operational metrics into `m` (nullptr stops); see SimMetrics.
+    void attachMetrics(SimMetrics *m)
+    {
+        metrics = m;
+        for (auto &h : hospitals)
+            h.attachMetrics(m);
+    }
+
+    // Close the recording with the final state hash.
+    void closeLog()
+    {
+        if (!log)
+            return;
+        log->setTick(tickCount);
+        log->checkpoint(stateHash(), true);
+        log->flush();
+    }
+
+    // FNV-1a over the dynamic state: clock, queues and every unit's
+    // position, status and route cursor. Equal hashes after a replay mean
+    // the rerun ended where the original did, bit for bit.
+    uint64_t stateHash() const
+    {
+        uint64_t h = 1469598103934665603ull;
+        auto mix = [&h](const void *p, size_t n)
+        {
+            const unsigned char *b = (const unsigned char *)p;
+            for (size_t i = 0; i < n; ++i)
+                h = (h ^ b[i]) * 1099511628211ull;
+        };
+        mix(&tickCount, sizeof tickCount);
+        mix(&clockMicros, sizeof clockMicros);
+        mix(&totalEmergencies, sizeof totalEmergencies);
+        for (auto &hosp : hospitals)
+        {
+            int counts[2] = {hosp.pendingCount(), hosp.handled()};
+            mix(counts, sizeof counts);
+            const FleetStore &f = hosp.getFleet();
+            int n = f.size();
+            mix(f.x.data(), n * sizeof(float));
+            mix(f.y.data(), n * sizeof(float));
+            mix(f.status.data(), n * sizeof(Ambulance::Status));
+            mix(f.pathLen.data(), n * sizeof(int));
+            mix(f.departAt.data(), n * sizeof(SimMicros));
+            mix(f.due.data(), n * sizeof(SimMicros));
+        }
+        return h;
+    }
+
+    // Thread-safe intake for call-takers: the call waits in a lock-free ring
+    // until the start of the next step, which submits everything queued.
+    // Returns the call number, or -1 when the ring is full.
+    int post(Emergency em, int hospitalIdx = -1)
+    {
+        int callId = nextCallId.fetch_add(1, memory_order_relaxed);
+        em.callId = callId;
+        return intake.tryPush(IntakeItem{std::move(em), hospitalIdx}) ? callId : -1;
+    }
+
+    // Queue an emergency at a hospital, by default the one the network
+    // expects to respond fastest; returns the hospital-local emergency id.
+    // The queued copy records the chosen hospital in assignedHospital. A
+    // call no hospital can take (there are none, or `hospitalIdx` names
+    // none) is dropped and counted; returns -1 then.
+    int submit(Emergency em, int hospitalIdx = -1)
+    {
+        if (log)
+        {
+            log->setTick(tickCount);
+            log->intake(hospitalIdx, em);
+        }
+        if (hospitalIdx < 0)
+            hospitalIdx = network.route(hospitals, em.location);
+        if (hospitalIdx < 0 || hospitalIdx >= (int)hospitals.size())
+        {
+            droppedCalls++;
+            if (metrics)
+                metrics->dropped.add();
+            return -1;
+        }
+        em.assignedHospital = hospitalIdx;
+        totalEmergencies++;
+        if (metrics)
+            metrics->calls.add();
+        int id = hospitals[hospitalIdx].receiveEmergency(em, time());
+        busy.push_back(hospitalIdx);
+        if (log)
+            log->routed(hospitalIdx, id);
+        settled = false; // the next step has a call to dispatch
+        return id;
+    }
+
+    // Advance the world by one fixed step.
+    void step()
+    {
+        profiler::Sequence stage; // shares timestamps between stages
+        PROFILE_NEXT(stage, "sim.intake");
+        if (log)
+            log->setTick(tickCount);
+        int work = intake.drain([this](IntakeItem &it) { submit(std::move(it.em), it.hospital); }, (int)intake.capacity());
+        PROFILE_NEXT(stage, "sim.balance");
+        sortBusy();
+        int lent = network.balance(hospitals, busy, log);
+        if (metrics && lent)
+            metrics->lent.add(lent);
+        work += lent;
+        // stage by stage over the hospitals with something to do; each still
+        // runs its stages in this order, and they touch only its own fleet
+        // and calls. The others are not visited at all.
+        PROFILE_NEXT(stage, "sim.dispatch");
+        sortBusy();
+        for (int hi : busy)
+        {
+            hospitals[hi].setClock(clockMicros);
+            work += hospitals[hi].dispatchVehicles(city);
+        }
+        PROFILE_NEXT(stage, "sim.events");
+        SimMicros until = clockMicros + stepMicros;
+        while (!dueAt.empty() && dueAt.topKey() <= until)
+            busy.push_back(dueAt.pop());
+        sortBusy();
+        for (int hi : busy)
+        {
+            Hospital &h = hospitals[hi];
+            work += h.processEvents(city, until);
+            applyIncidentChanges(h.incidentChanges());
+            if (h.nextEventTime() == numeric_limits<SimMicros>::max())
+                dueAt.erase(hi);
+            else
+                dueAt.push(hi, h.nextEventTime());
+        }
+        busy.erase(remove_if(busy.begin(), busy.end(), [this](int hi)
+                             { return hospitals[hi].pendingCount() == 0 && !hospitals[hi].dispatchDue(); }),
+                   busy.end());
+        settled = work == 0;
+        if (metrics)
+            sampleFleet(1);
+        clockMicros += stepMicros;
+        tickCount++;
+        if (log && tickCount % checkpointEvery == 0)
+        {
+            log->setTick(tickCount);
+            log->checkpoint(stateHash());
+        }
+    }
+
+    // Runs steps up to tick `until`. Where the last step changed nothing and
+    // no call is waiting in the intake, every step before the next unit
+    // event would change nothing either, so those ticks are passed over in
+    // one jump. The result is the same as stepping each tick (log
+    // checkpoints included); only calls submitted from outside have to
+    // wait for the tick they are due at. Changes made to a hospital through
+    // getHospitals() are not seen here: step() once after them.
+    void runUntil(long long until)
+    {
+        while (tickCount < until)
+        {
+            if (settled && intake.empty())
+            {
+                long long to = min(until, eventTick());
+                if (log)
+                    to = min(to, (tickCount / checkpointEvery + 1) * checkpointEvery - 1); // step at the checkpoint
+                if (to > tickCount)
+                {
+                    if (metrics)
+                        sampleFleet(to - tickCount);
+                    clockMicros += (to - tickCount) * stepMicros;
+                    tickCount = to;
+                    continue;
+                }
+            }
+            step();
+        }
+    }
+
+    // First tick whose time() is at least `seconds`: when a call due then
+    // is submitted by a driver that steps until time() reaches it. Times
+    // that are not finite or lie beyond any reachable tick (a driver with
+    // no more calls) give the largest tick.
+    long long tickAt(double seconds) const
+    {
+        if (!(seconds <= toSeconds(numeric_limits<SimMicros>::max() / 2)))
+            return numeric_limits<long long>::max();
+        if (seconds <= 0.0)
+            return 0;
+        long long t = (long long)ceil(seconds * 1e6 / stepMicros);
+        // the division can round either way by a step; time() decides
+        if (t > 0 && toSeconds((t - 1) * stepMicros) >= seconds)
+            t--;
+        else if (toSeconds(t * stepMicros) < seconds)
+            t++;
+        return t;
+    }
+
+    // Fixed-timestep driver for variable frame times: runs as many steps as
+    // fit into the accumulated time, capped so a long stall cannot spiral.
+    int advance(float frameDt)
+    {
+        accumulator += toMicros(frameDt);
+        int steps = 0;
+        while (accumulator >= stepMicros && steps < maxStepsPerAdvance)
+        {
+            step();
+            accumulator -= stepMicros;
+            steps++;
+        }
+        if (steps == maxStepsPerAdvance)
+            accumulator = 0;
+        return steps;
+    }
+
+    void snapshot(WorldSnapshot &out) const
+    {
+        out.simTime = time();
+        out.tick = tickCount;
+        out.totalEmergencies = totalEmergencies;
+        int fleetTotal = 0;
+        for (auto &h : hospitals)
+            fleetTotal += h.fleetSize();
+        out.ambulances.resize(fleetTotal); // resized in place so label strings keep their buffers
+        out.pathPoints.clear();
+        out.hospitals.resize(hospitals.size());
+        int slot = 0;
+        for (size_t hi = 0; hi < hospitals.size(); ++hi)
+        {
+            const Hospital &h = hospitals[hi];
+            HospitalView &hv = out.hospitals[hi];
+            hv.location = h.getLocation();
+            hv.firstAmbulance = slot;
+            hv.ambulanceCount = h.fleetSize();
+            hv.pending = h.pendingCount();
+            hv.handled = h.handled();
+            if (hv.queueVersion != h.queueVersion())
+            {
+                // only re-read the queue when it changed; strings reuse their buffers
+                h.peekPending(WorldSnapshot::queuePreview, pendingScratch);
+                hv.pendingTop.resize(pendingScratch.size());
+                for (size_t j = 0; j < pendingScratch.size(); ++j)
+                {
+                    const Emergency &em = *pendingScratch[j];
+                    PendingView &pv = hv.pendingTop[j];
+                    pv.id = em.id;
+                    pv.priority = em.priority;
+                    pv.name = em.patient.name;
+                    pv.severity = em.patient.severity;
+                }
+                hv.queueVersion = h.queueVersion();
+            }
+            const FleetStore &f = h.getFleet();
+            for (int i = 0; i < f.size(); ++i)
+            {
+                AmbulanceView &v = out.ambulances[slot++];
+                v.id = f.id[i];
+                v.hospital = (int)hi;
+                int next = 0;
+                v.pos = f.positionAt(i, clockMicros, &next);
+                v.parkingPos = f.parking(i);
+                v.status = f.status[i];
+                v.onSceneTimer = f.status[i] == Ambulance::Status::ON_SCENE ? (float)toSeconds(f.due[i] - clockMicros) : 0.0f;
+                v.assignedHouseId = f.task[i].houseId;
+                v.assignedEmergencyId = f.task[i].emergencyId;
+                v.assignedPatientName = f.task[i].patientName;
+                v.pathBegin = (int)out.pathPoints.size();
+                out.pathPoints.insert(out.pathPoints.end(), f.path(i) + min(next, f.pathLen[i]), f.path(i) + f.pathLen[i]);
+                v.pathEnd = (int)out.pathPoints.size();
+            }
+        }
+        out.activeHouses.assign(activeHouses.begin(), activeHouses.end());
+    }
+
+    const CityMap &map() const { return city; }
+    const HospitalNetwork &getNetwork() const { return network; }
+
+    // Dispatch policy of every hospital, current and future. Set it before
+    // attaching an event log; the log records it for replay.
+    void setDispatchMode(DispatchMode m)
+    {
+        dispatch = m;
+        for (auto &h : hospitals)
+            h.setDispatchMode(m);
+        settled = false;
+    }
+    DispatchMode dispatchMode() const { return dispatch; }
+
+    // Rank idle units for greedy dispatch by table lookups instead of A*
+    // (nullptr goes back to A*). The table must belong to this city's road
+    // graph. Set it before attaching an event log; the log records whether
+    // one is in use, and a replay builds its own.
+    void setDistanceTable(shared_ptr<const DistanceTable> table)
+    {
+        city.distances = move(table);
+        settled = false;
+    }
+    const DistanceTable *distanceTable() const { return city.distances.get(); }
+
+    EventLog *eventLog() const { return log; }
+    vector<Hospital> &getHospitals() { return hospitals; }
+    const vector<Hospital> &getHospitals() const { return hospitals; }
+    double time() const { return toSeconds(clockMicros); }
+    SimMicros now() const { return clockMicros; }
+    long long ticks() const { return tickCount; }
+    float fixedStep() const { return fixedDt; }
+    SimMicros fixedStepMicros() const { return stepMicros; }
+    int emergencyCount() const { return totalEmergencies; }
+    int droppedCount() const { return droppedCalls; }
+
+    // Indices of the houses a unit is driving to or working at.
+    const vector<int> &activeIncidents() const { return activeHouses; }
+
+private:
+    CityMap city;
+    vector<Hospital> hospitals;
+    HospitalNetwork network;
+    DispatchMode dispatch = DispatchMode::GREEDY;
+    int nextAmbulanceId = 1;
+    int totalEmergencies = 0;
+    int droppedCalls = 0; // submitted with no hospital to take them
+    SimMicros clockMicros = 0;
+    long long tickCount = 0;
+    SimMicros stepMicros;
+    float fixedDt; // stepMicros in seconds, as logged
+    SimMicros accumulator = 0;
+    bool settled = false; // the last step changed nothing
+    int maxStepsPerAdvance = 8;
+    EventLog *log = nullptr;
+    SimMetrics *metrics = nullptr;
+    IntakeQueue<IntakeItem> intake;   // calls posted from any thread
+    atomic<int> nextCallId{1};
+    static const int checkpointEvery = 1200; // ticks between logged state hashes
+    static constexpr float maxFleetCells = 16384; // idle-unit grid cells per hospital
+    mutable vector<const Emergency *> pendingScratch;
+
+    // The hospitals a step visits: those with calls waiting or a dispatch
+    // due, plus, while it runs its events stage, those with a unit event in
+    // the step. dueAt holds every hospital's next unit event time.
+    vector<int> busy;
+    IndexedHeap<SimMicros> dueAt; // by hospital index, earliest first
+
+    // The houses with units en route or on scene, kept up to date from the
+    // hospitals' dispatch and scene-cleared events. Keyed on those houses
+    // only, so nothing here grows with the size of the city.
+    struct ActiveHouse
+    {
+        int units = 0;
+        int slot = 0; // position in activeHouses
+    };
+    unordered_map<int, ActiveHouse> activeByHouse; // by house index
+    vector<int> activeHouses;
+
+    // Tick whose step runs the earliest unit event: the step from tick k
+    // runs events due up to (k + 1) steps. Far in the future when no unit
+    // has one.
+    long long eventTick() const
+    {
+        if (dueAt.empty())
+            return numeric_limits<long long>::max();
+        return max<long long>(tickCount, (dueAt.topKey() + stepMicros - 1) / stepMicros - 1);
+    }
+
+    // Ascending, without repeats: stages visit hospitals in index order, as
+    // the log and the replay expect.
+    void sortBusy()
+    {
+        sort(busy.begin(), busy.end());
+        busy.erase(unique(busy.begin(), busy.end()), busy.end());
+    }
+
+    // Fleet utilization and queue depth over the last `ticks` ticks.
+    void sampleFleet(long long ticks)
+    {
+        int total = 0, idle = 0, waiting = 0;
+        for (auto &h : hospitals)
+        {
+            total += h.fleetSize();
+            idle += h.idleCount();
+            waiting += h.pendingCount();
+        }
+        int busy = total - idle;
+        metrics->busyUnitMicros.add(busy * stepMicros * ticks);
+        metrics->unitMicros.add(total * stepMicros * ticks);
+        metrics->busyUnits.set(busy);
+        metrics->units.set(total);
+        metrics->utilization.set(total ? (double)busy / total : 0.0);
+        metrics->queueDepth.set(waiting);
+    }
+
+    void applyIncidentChanges(vector<IncidentChange> &changes)
+    {
+        for (const IncidentChange &c : changes)
+        {
+            int i = city.houseIndex(c.houseId);
+            if (i < 0)
+                continue; // call not tied to a house
+            auto it = activeByHouse.find(i);
+            if (it == activeByHouse.end())
+            {
+                if (c.delta <= 0)
+                    continue;
+                it = activeByHouse.emplace(i, ActiveHouse{0, (int)activeHouses.size()}).first;
+                activeHouses.push_back(i);
+                city.houses[i].hasEmergency = true;
+            }
+            it->second.units += c.delta;
+            if (it->second.units <= 0)
+            {
+                int slot = it->second.slot, last = activeHouses.back();
+                activeHouses[slot] = last;
+                activeByHouse[last].slot = slot;
+                activeHouses.pop_back();
+                activeByHouse.erase(i);
+                city.houses[i].hasEmergency = false;
+            }
+        }
+        changes.clear();
+    }
+};
+
+// Single hospital centred above the map with four parking bays, as in the
+// original layout.
+inline Hospital &placeDefaultHospital(Simulation &sim)
+{
+    const CityMap &m = sim.map();
+    float hospCenterX = m.cfg.startX + m.mapWidth / 2.0f;
+    float hospY = m.cfg.startY - 100;
+    vector<Vec2> parking = {
+        {hospCenterX - 70, hospY + 30}, // Left side parking
+        {hospCenterX - 35, hospY + 30},
+        {hospCenterX + 35, hospY + 30},
+        {hospCenterX + 70, hospY + 30}  // Right side parking
+    };
+    return sim.addHospital(Vec2{hospCenterX, hospY}, parking, 4.0f);
+}
+
+// `count` hospitals spread evenly over the grid's intersections, each with
+// `units` ambulances parked along the crossing roads.
+inline void placeHospitalGrid(Simulation &sim, int count, int units = 4)
+{
+    const CityMap &m = sim.map();
+    const CityConfig &cfg = m.cfg;
+    Rect b = m.bounds();
+    // mean block size, which is cfg.blockSize unless the blocks are uneven
+    float stepX = (b.width - 2 * cfg.roadW) / cfg.blocksX, stepY = (b.height - 2 * cfg.roadW) / cfg.blocksY;
+    int cols = max(1, (int)ceilf(sqrtf((float)count)));
+    int rows = (count + cols - 1) / cols;
+    for (int i = 0; i < count; ++i)
+    {
+        int ix = (int)((i % cols + 0.5f) * (cfg.blocksX + 1) / cols);
+        int iy = (int)((i / cols + 0.5f) * (cfg.blocksY + 1) / rows);
+        Vec2 loc = {cfg.startX + ix * stepX, cfg.startY + iy * stepY};
+        loc = m.graph.position(m.snapper.nearest(loc));
+        vector<Vec2> parking;
+        for (int u = 0; u < units; ++u)
+        {
+            float off = 12.0f * (u / 4 + 1);
+            Vec2 dir = u % 4 == 0 ? Vec2{1, 0} : u % 4 == 1 ? Vec2{-1, 0} : u % 4 == 2 ? Vec2{0, 1} : Vec2{0, -1};
+            parking.push_back({loc.x + dir.x * off, loc.y + dir.y * off});
+        }
+        sim.addHospital(loc, parking, 4.0f);
+    }
+}